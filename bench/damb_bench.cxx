@@ -0,0 +1,265 @@
+#include "damb_file.hxx"
+#include "damb_loader.hxx"
+#include "utility_arena.hxx"
+#include "utility_histogram.hxx"
+#include "utility_parse.hxx"
+
+#include <SDL3/SDL.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// times each DambLoader phase separately over repeated loads of one .damb file;
+// renders into an offscreen software renderer so it needs no display
+namespace {
+    namespace damb = amb::damb;
+
+    using Clock = std::chrono::steady_clock;
+
+    struct BenchOptions {
+        std::filesystem::path damb_path;
+        u32 iterations = 10;
+        u32 warmup = 1;
+    };
+
+    // one row of the report; bytes are per iteration
+    struct Phase {
+        const char* name = "";
+        std::vector<double> samples_ms;
+        u64 bytes_in = 0;
+        u64 bytes_out = 0;
+    };
+
+    enum PhaseIndex : std::size_t {
+        PHASE_OPEN,
+        PHASE_CHECKSUM,
+        PHASE_ATLAS,
+        PHASE_IMAGE_DECODE,
+        PHASE_IMAGE_UPLOAD,
+        PHASE_MAP,
+        PHASE_COUNT,
+    };
+
+    void printUsage(std::ostream& out) {
+        out << "Usage:\n"
+            << "  damb_bench <file.damb> [--iterations <n>] [--warmup <n>]\n";
+    }
+
+    BenchOptions parseOptions(int argc, char** argv) {
+        if (argc < 2) {
+            throw std::invalid_argument("missing input path");
+        }
+
+        BenchOptions options;
+        options.damb_path = argv[1];
+
+        for (int i = 2; i < argc; i += 2) {
+            const std::string option = argv[i];
+            if (i + 1 >= argc) {
+                throw std::runtime_error(option + " expects a value.");
+            }
+
+            if (option == "--iterations") {
+                options.iterations = std::max<u32>(1, amb::utility::parseCount(argv[i + 1], option));
+            } else if (option == "--warmup") {
+                options.warmup = amb::utility::parseCount(argv[i + 1], option);
+            } else {
+                throw std::runtime_error("Unknown option: " + option);
+            }
+        }
+
+        return options;
+    }
+
+    double elapsedMs(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    class LoaderBench {
+    public:
+        LoaderBench(const BenchOptions& options, SDL_Renderer* renderer)
+        : m_options(options),
+          m_renderer(renderer),
+          m_loader(DambLoader::ChecksumPolicy::never) {
+            m_phases[PHASE_OPEN].name = "header+toc";
+            m_phases[PHASE_CHECKSUM].name = "crc32";
+            m_phases[PHASE_ATLAS].name = "atlas";
+            m_phases[PHASE_IMAGE_DECODE].name = "image decode";
+            m_phases[PHASE_IMAGE_UPLOAD].name = "image upload";
+            m_phases[PHASE_MAP].name = "map cells";
+        }
+
+        void run() {
+            for (u32 i = 0; i < m_options.warmup; i++) {
+                iterate(false);
+            }
+
+            for (u32 i = 0; i < m_options.iterations; i++) {
+                iterate(true);
+            }
+        }
+
+        void report(std::ostream& out) const {
+            out << m_options.damb_path.string() << ": " << m_options.iterations << " iterations ("
+                << m_options.warmup << " warmup)\n";
+            out << std::left << std::setw(14) << "phase" << std::right
+                << std::setw(10) << "min ms" << std::setw(10) << "p50 ms" << std::setw(10) << "p90 ms"
+                << std::setw(10) << "p99 ms" << std::setw(10) << "max ms"
+                << std::setw(12) << "in MB/s" << std::setw(12) << "out MB/s" << '\n';
+
+            out << std::fixed;
+            for (const Phase& phase : m_phases) {
+                std::vector<double> sorted = phase.samples_ms;
+                std::sort(sorted.begin(), sorted.end());
+                if (sorted.empty()) {
+                    continue;
+                }
+
+                const double p50 = amb::utility::sortedPercentile(sorted, 50.0);
+                const auto throughput = [p50](u64 bytes) {
+                    return (p50 > 0.0) ? (static_cast<double>(bytes) / (1024.0 * 1024.0)) / (p50 / 1000.0) : 0.0;
+                };
+
+                out << std::left << std::setw(14) << phase.name << std::right << std::setprecision(3)
+                    << std::setw(10) << sorted.front()
+                    << std::setw(10) << p50
+                    << std::setw(10) << amb::utility::sortedPercentile(sorted, 90.0)
+                    << std::setw(10) << amb::utility::sortedPercentile(sorted, 99.0)
+                    << std::setw(10) << sorted.back()
+                    << std::setprecision(1)
+                    << std::setw(12) << throughput(phase.bytes_in)
+                    << std::setw(12) << throughput(phase.bytes_out) << '\n';
+            }
+        }
+
+    private:
+        void iterate(bool record) {
+            Clock::time_point start = Clock::now();
+            const DambFile file(m_options.damb_path);
+            sample(PHASE_OPEN, start, record,
+                damb::HEADER_SIZE + file.toc().size() * sizeof(damb::TocEntry),
+                file.toc().size() * sizeof(damb::TocEntry));
+
+            start = Clock::now();
+            file.verifyChecksums(1);
+            sample(PHASE_CHECKSUM, start, record, storedBytes(file), storedBytes(file));
+
+            std::map<u16, AtlasRuntime> atlases;
+            u64 atlas_in = 0;
+            u64 atlas_out = 0;
+            start = Clock::now();
+            for (const damb::TocEntry* entry : file.chunksOfType(damb::CL_ATLAS)) {
+                m_scratch.reset();
+                atlases.emplace(entry->id, m_loader.loadAtlasRuntime(m_loader.chunkData(file, *entry, m_scratch), *entry));
+                atlas_in += entry->size;
+                atlas_out += entry->uncompressed_size;
+            }
+            sample(PHASE_ATLAS, start, record, atlas_in, atlas_out);
+
+            std::vector<SurfacePtr> surfaces;
+            u64 image_in = 0;
+            u64 image_out = 0;
+            start = Clock::now();
+            for (const damb::TocEntry* entry : file.chunksOfType(damb::CL_IMAGE)) {
+                m_scratch.reset();
+                surfaces.push_back(m_loader.decodeImageSurface(m_loader.chunkData(file, *entry, m_scratch), *entry));
+                image_in += entry->size;
+                image_out += static_cast<u64>(surfaces.back()->h) * static_cast<u64>(surfaces.back()->pitch);
+            }
+            sample(PHASE_IMAGE_DECODE, start, record, image_in, image_out);
+
+            start = Clock::now();
+            for (const SurfacePtr& surface : surfaces) {
+                const ImageRuntime uploaded = m_loader.uploadImageRuntime(surface.get(), m_renderer);
+                (void)uploaded;
+            }
+            sample(PHASE_IMAGE_UPLOAD, start, record, image_out, image_out);
+
+            u64 map_in = 0;
+            u64 map_out = 0;
+            start = Clock::now();
+            for (const damb::TocEntry* entry : file.chunksOfType(damb::CL_MAP_LAYER)) {
+                m_scratch.reset();
+                const amb::utility::ByteSpan map_chunk = m_loader.chunkData(file, *entry, m_scratch);
+                const damb::MapLayerChunkHeader header = m_loader.loadMapLayerHeader(map_chunk, *entry);
+
+                const auto atlas = atlases.find(header.atlas_id);
+                if (atlas == atlases.end()) {
+                    throw std::runtime_error("MAPL id=" + std::to_string(entry->id) + " references a missing atlas.");
+                }
+
+                const DambLoader::AtlasChunkMetadata metadata {
+                    static_cast<u32>(atlas->second.rects.size()),
+                    atlas->second.image_id,
+                };
+                const MapRuntime map_runtime = m_loader.loadMapRuntime(map_chunk, header, metadata);
+                map_in += entry->size;
+                map_out += static_cast<u64>(map_runtime.cellCount()) * sizeof(Cell);
+            }
+            sample(PHASE_MAP, start, record, map_in, map_out);
+        }
+
+        static u64 storedBytes(const DambFile& file) {
+            u64 bytes = 0;
+            for (const damb::TocEntry& entry : file.toc()) {
+                bytes += entry.size;
+            }
+            return bytes;
+        }
+
+        void sample(PhaseIndex index, Clock::time_point start, bool record, u64 bytes_in, u64 bytes_out) {
+            const double ms = elapsedMs(start);
+            if (!record) {
+                return;
+            }
+
+            m_phases[index].samples_ms.push_back(ms);
+            m_phases[index].bytes_in = bytes_in;
+            m_phases[index].bytes_out = bytes_out;
+        }
+
+        const BenchOptions& m_options;
+        SDL_Renderer* m_renderer = nullptr;
+        DambLoader m_loader;
+        amb::utility::ScratchArena m_scratch;
+        Phase m_phases[PHASE_COUNT];
+    };
+}
+
+int main(int argc, char** argv) {
+    try {
+        const BenchOptions options = parseOptions(argc, argv);
+
+        // uploads go to an offscreen surface, so no video driver or display is involved
+        SurfacePtr target(SDL_CreateSurface(64, 64, SDL_PIXELFORMAT_ABGR8888));
+        if (target == nullptr) {
+            throw std::runtime_error(std::string("Failed to create render target: ") + SDL_GetError());
+        }
+
+        RendererPtr renderer(SDL_CreateSoftwareRenderer(target.get()));
+        if (renderer == nullptr) {
+            throw std::runtime_error(std::string("Failed to create software renderer: ") + SDL_GetError());
+        }
+
+        LoaderBench bench(options, renderer.get());
+        bench.run();
+        bench.report(std::cout);
+        return 0;
+    } catch (const std::invalid_argument&) {
+        printUsage(std::cout);
+        return 1;
+    } catch (const std::exception& ex) {
+        std::cerr << "damb_bench error: " << ex.what() << '\n';
+        return 1;
+    }
+}
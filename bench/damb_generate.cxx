@@ -0,0 +1,556 @@
+#include "damb_anim.hxx"
+#include "damb_atls.hxx"
+#include "damb_ents.hxx"
+#include "damb_format.hxx"
+#include "damb_imag.hxx"
+#include "damb_mapl.hxx"
+#include "damb_mapl_encode.hxx"
+
+#include "utility_binary.hxx"
+#include "utility_crc.hxx"
+#include "utility_lz.hxx"
+#include "utility_parse.hxx"
+
+#include <SDL3/SDL.h>
+#include <SDL3_image/SDL_image.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// writes synthetic .damb packs of arbitrary size for the loader benchmark; chunks are
+// streamed to disk one at a time so only the largest single chunk has to fit in memory
+namespace {
+    namespace damb = amb::damb;
+
+    enum class MapPattern {
+        noise,   // every cell independent: worst case for run-length, best for palette
+        runs,    // horizontal runs of 1..64 equal cells
+        sparse,  // mostly record 0 with scattered detail
+    };
+
+    enum class MapEncodingChoice {
+        smallest,
+        raw,
+        run_length,
+        palette,
+    };
+
+    struct GeneratorOptions {
+        std::filesystem::path output_path;
+        u32 layer_count = 1;
+        u32 image_count = 1;
+        u32 map_width = 1024;
+        u32 map_height = 1024;
+        u32 atlas_records = 256;
+        u32 animations = 0;
+        u32 solid_records = 0;
+        u32 entities = 0;
+        u32 image_width = 1024;
+        u32 image_height = 1024;
+        damb::ImageFormat image_format = damb::ImageFormat::png;
+        MapPattern pattern = MapPattern::runs;
+        MapEncodingChoice encoding = MapEncodingChoice::smallest;
+        damb::ChunkCompression compression = damb::ChunkCompression::none;
+        u32 seed = 1;
+    };
+
+    // xorshift32; deterministic across platforms so corpora can be regenerated byte for byte
+    class Random {
+    public:
+        explicit Random(u32 seed) noexcept
+        : m_state(seed == 0 ? 0x9E3779B9u : seed) {}
+
+        u32 next() noexcept {
+            m_state ^= m_state << 13;
+            m_state ^= m_state >> 17;
+            m_state ^= m_state << 5;
+            return m_state;
+        }
+
+        u32 below(u32 bound) noexcept { return (bound == 0) ? 0 : next() % bound; }
+
+    private:
+        u32 m_state;
+    };
+
+    void printUsage(std::ostream& out) {
+        out << "Usage:\n"
+            << "  damb_generate <output.damb> [options]\n"
+            << "Options:\n"
+            << "  --layers <n>              MAPL chunks (default 1)\n"
+            << "  --images <n>              IMAG/ATLS pairs shared round-robin by the layers (default 1)\n"
+            << "  --map <w>x<h>             cells per layer (default 1024x1024, up to 65535x65535)\n"
+            << "  --atlas-records <n>       records per ATLS chunk (default 256, max 65535)\n"
+            << "  --animations <n>          animated records per atlas, written as an ANIM chunk (default 0)\n"
+            << "  --solid-records <n>       records 1..n are flagged solid for collision (default 0)\n"
+            << "  --entities <n>            npcs on the first layer, written as an ENTS chunk (default 0, max 65535)\n"
+            << "  --image <w>x<h>           pixels per IMAG chunk (default 1024x1024)\n"
+            << "  --image-format <png|rgba> (default png)\n"
+            << "  --pattern <noise|runs|sparse>          map cell layout (default runs)\n"
+            << "  --encoding <auto|raw|rle|palette>      MAPL payload encoding (default auto = smallest)\n"
+            << "  --compress <none|lz4>     chunk compression (default none)\n"
+            << "  --seed <n>                (default 1)\n";
+    }
+
+    void parseDimensions(const std::string& value, const std::string& option, u32 max_value, u32& width, u32& height) {
+        const std::size_t separator = value.find('x');
+        if (separator == std::string::npos) {
+            throw std::runtime_error(option + " expects <w>x<h>, got: " + value);
+        }
+
+        width = amb::utility::parseCount(value.substr(0, separator), option, 1, max_value);
+        height = amb::utility::parseCount(value.substr(separator + 1), option, 1, max_value);
+    }
+
+    GeneratorOptions parseOptions(int argc, char** argv) {
+        if (argc < 2) {
+            throw std::invalid_argument("missing output path");
+        }
+
+        GeneratorOptions options;
+        options.output_path = argv[1];
+
+        for (int i = 2; i < argc; i += 2) {
+            const std::string option = argv[i];
+            if (i + 1 >= argc) {
+                throw std::runtime_error(option + " expects a value.");
+            }
+            const std::string value = argv[i + 1];
+
+            if (option == "--layers") {
+                options.layer_count = amb::utility::parseCount(value, option, 1, std::numeric_limits<u16>::max());
+            } else if (option == "--images") {
+                options.image_count = amb::utility::parseCount(value, option, 1, std::numeric_limits<u16>::max());
+            } else if (option == "--map") {
+                parseDimensions(value, option, std::numeric_limits<u16>::max(), options.map_width, options.map_height);
+            } else if (option == "--atlas-records") {
+                options.atlas_records = amb::utility::parseCount(value, option, 1, std::numeric_limits<u16>::max());
+            } else if (option == "--animations") {
+                options.animations = amb::utility::parseCount(value, option, 0, std::numeric_limits<u16>::max());
+            } else if (option == "--solid-records") {
+                options.solid_records = amb::utility::parseCount(value, option, 0, std::numeric_limits<u16>::max());
+            } else if (option == "--entities") {
+                options.entities = amb::utility::parseCount(value, option, 0, std::numeric_limits<u16>::max());
+            } else if (option == "--image") {
+                parseDimensions(value, option, std::numeric_limits<u16>::max(), options.image_width, options.image_height);
+            } else if (option == "--image-format") {
+                if (value == "png") {
+                    options.image_format = damb::ImageFormat::png;
+                } else if (value == "rgba") {
+                    options.image_format = damb::ImageFormat::rgba;
+                } else {
+                    throw std::runtime_error("--image-format expects png or rgba, got: " + value);
+                }
+            } else if (option == "--pattern") {
+                if (value == "noise") {
+                    options.pattern = MapPattern::noise;
+                } else if (value == "runs") {
+                    options.pattern = MapPattern::runs;
+                } else if (value == "sparse") {
+                    options.pattern = MapPattern::sparse;
+                } else {
+                    throw std::runtime_error("--pattern expects noise, runs or sparse, got: " + value);
+                }
+            } else if (option == "--encoding") {
+                if (value == "auto") {
+                    options.encoding = MapEncodingChoice::smallest;
+                } else if (value == "raw") {
+                    options.encoding = MapEncodingChoice::raw;
+                } else if (value == "rle") {
+                    options.encoding = MapEncodingChoice::run_length;
+                } else if (value == "palette") {
+                    options.encoding = MapEncodingChoice::palette;
+                } else {
+                    throw std::runtime_error("--encoding expects auto, raw, rle or palette, got: " + value);
+                }
+            } else if (option == "--compress") {
+                if (value == "none") {
+                    options.compression = damb::ChunkCompression::none;
+                } else if (value == "lz4") {
+                    options.compression = damb::ChunkCompression::lz4;
+                } else {
+                    throw std::runtime_error("--compress expects none or lz4, got: " + value);
+                }
+            } else if (option == "--seed") {
+                options.seed = amb::utility::parseCount(value, option, 0, std::numeric_limits<u32>::max());
+            } else {
+                throw std::runtime_error("Unknown option: " + option);
+            }
+        }
+
+        if (options.animations > options.atlas_records) {
+            throw std::runtime_error("--animations cannot exceed --atlas-records.");
+        }
+
+        if (options.solid_records > 0 && options.solid_records >= options.atlas_records) {
+            throw std::runtime_error("--solid-records must stay below --atlas-records; record 0 is never solid.");
+        }
+
+        if (options.image_count > options.layer_count) {
+            throw std::runtime_error("--images cannot exceed --layers.");
+        }
+
+        return options;
+    }
+
+    class DambStreamWriter {
+    public:
+        explicit DambStreamWriter(const std::filesystem::path& path)
+        : m_path(path), m_out(path, std::ios::binary | std::ios::trunc) {
+            if (!m_out.is_open()) {
+                throw std::runtime_error("Unable to open output file for writing: " + path.string());
+            }
+
+            // the header is rewritten once the TOC position is known
+            const std::vector<char> placeholder(damb::HEADER_SIZE, '\0');
+            m_out.write(placeholder.data(), static_cast<std::streamsize>(placeholder.size()));
+            m_cursor = damb::HEADER_SIZE;
+        }
+
+        void writeChunk(const char* type, u16 id, std::vector<u8> bytes, damb::ChunkCompression compression) {
+            damb::TocEntry toc {};
+            std::memcpy(toc.type, type, amb::data::CHUNK_TYPE_LENGTH);
+            toc.id = id;
+            toc.offset = m_cursor;
+            toc.uncompressed_size = bytes.size();
+
+            if (compression != damb::ChunkCompression::none) {
+                std::vector<u8> compressed = amb::utility::lzCompress(bytes.data(), bytes.size());
+                if (compressed.size() < bytes.size()) {
+                    bytes = std::move(compressed);
+                    toc.flags = static_cast<u32>(compression);
+                }
+            }
+
+            toc.size = bytes.size();
+            toc.crc32 = amb::utility::crc32(bytes.data(), bytes.size());
+
+            m_out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            const u64 padding = damb::PadTo8(m_cursor + bytes.size());
+            const char zeroes[8] = {};
+            m_out.write(zeroes, static_cast<std::streamsize>(padding));
+            if (!m_out) {
+                throw std::runtime_error("Failed writing chunk payload to " + m_path.string());
+            }
+
+            m_cursor += bytes.size() + padding;
+            m_toc.push_back(toc);
+        }
+
+        u64 finish() {
+            damb::Header header {};
+            std::memcpy(header.magic, damb::MAGIC, amb::data::MAGIC_LENGTH);
+            header.toc_offset = m_cursor;
+            header.toc_count = static_cast<u32>(m_toc.size());
+            header.toc_entry_size = damb::TOC_ENTRY_SIZE;
+            header.flags = damb::HEADER_FLAG_CHUNK_CRC32;
+            header.version = damb::VERSION;
+            header.file_size = m_cursor + static_cast<u64>(m_toc.size()) * damb::TOC_ENTRY_SIZE;
+
+            m_out.write(reinterpret_cast<const char*>(m_toc.data()), static_cast<std::streamsize>(m_toc.size() * sizeof(damb::TocEntry)));
+            m_out.seekp(0);
+            m_out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            m_out.close();
+            if (!m_out) {
+                throw std::runtime_error("Failed finishing " + m_path.string());
+            }
+
+            return header.file_size;
+        }
+
+    private:
+        std::filesystem::path m_path;
+        std::ofstream m_out;
+        u64 m_cursor = 0;
+        std::vector<damb::TocEntry> m_toc;
+    };
+
+    // tile-like pixels with some noise so PNG decode cost is representative of real art
+    SurfacePtr generatePixels(u32 width, u32 height, Random& random) {
+        SurfacePtr surface(SDL_CreateSurface(static_cast<int>(width), static_cast<int>(height), SDL_PIXELFORMAT_ABGR8888));
+        if (surface == nullptr) {
+            throw std::runtime_error(std::string("Failed to allocate image surface: ") + SDL_GetError());
+        }
+
+        auto* pixels = static_cast<u8*>(surface->pixels);
+        for (u32 y = 0; y < height; y++) {
+            u8* row = pixels + static_cast<std::size_t>(y) * static_cast<std::size_t>(surface->pitch);
+            for (u32 x = 0; x < width; x++) {
+                const u32 noise = random.next();
+                row[x * 4 + 0] = static_cast<u8>(((x / 16) * 37 + (noise & 0x7)) & 0xFF);
+                row[x * 4 + 1] = static_cast<u8>(((y / 16) * 59 + ((noise >> 3) & 0x7)) & 0xFF);
+                row[x * 4 + 2] = static_cast<u8>((x ^ y) & 0xFF);
+                row[x * 4 + 3] = 0xFF;
+            }
+        }
+
+        return surface;
+    }
+
+    std::vector<u8> encodeImagePayload(const GeneratorOptions& options, SDL_Surface* surface, u32& pitch) {
+        const std::size_t row_size = static_cast<std::size_t>(options.image_width) * damb::IMAG_RGBA_BYTES_PER_PIXEL;
+
+        if (options.image_format == damb::ImageFormat::rgba) {
+            pitch = static_cast<u32>(row_size);
+            std::vector<u8> bytes(row_size * options.image_height);
+            const auto* src = static_cast<const u8*>(surface->pixels);
+            for (u32 y = 0; y < options.image_height; y++) {
+                std::memcpy(bytes.data() + y * row_size, src + static_cast<std::size_t>(y) * static_cast<std::size_t>(surface->pitch), row_size);
+            }
+            return bytes;
+        }
+
+        // SDL_image only saves PNGs to a path or stream; a temporary file keeps this portable
+        pitch = 0;
+        const std::filesystem::path temp_path = options.output_path.string() + ".png.tmp";
+        if (!IMG_SavePNG(surface, temp_path.string().c_str())) {
+            throw std::runtime_error(std::string("Failed to encode PNG: ") + SDL_GetError());
+        }
+
+        std::ifstream stream(temp_path, std::ios::binary);
+        std::vector<u8> bytes((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+        stream.close();
+        std::filesystem::remove(temp_path);
+
+        if (bytes.empty()) {
+            throw std::runtime_error("Encoded PNG is empty: " + temp_path.string());
+        }
+
+        return bytes;
+    }
+
+    std::vector<u8> buildImageChunk(const GeneratorOptions& options, u16 id, Random& random) {
+        const SurfacePtr surface = generatePixels(options.image_width, options.image_height, random);
+
+        damb::ImageChunkHeader header {};
+        std::memcpy(header.header.type, damb::CL_IMAGE, amb::data::CHUNK_TYPE_LENGTH);
+        header.header.id = id;
+        header.width = options.image_width;
+        header.height = options.image_height;
+        header.format = options.image_format;
+
+        const std::vector<u8> payload = encodeImagePayload(options, surface.get(), header.pitch);
+        header.size = payload.size();
+
+        std::vector<u8> bytes;
+        bytes.reserve(damb::IMAG_HEADER_SIZE + payload.size());
+        amb::utility::appendPod(bytes, header);
+        bytes.insert(bytes.end(), payload.begin(), payload.end());
+        return bytes;
+    }
+
+    std::vector<u8> buildAtlasChunk(const GeneratorOptions& options, u16 id, u16 image_id) {
+        // records tile the image in a square-ish grid
+        const u32 columns = static_cast<u32>(std::ceil(std::sqrt(static_cast<double>(options.atlas_records))));
+        const u32 rows = (options.atlas_records + columns - 1) / columns;
+        const u16 tile_w = static_cast<u16>(std::max<u32>(1, options.image_width / columns));
+        const u16 tile_h = static_cast<u16>(std::max<u32>(1, options.image_height / rows));
+
+        damb::AtlasChunkHeader header {};
+        std::memcpy(header.header.type, damb::CL_ATLAS, amb::data::CHUNK_TYPE_LENGTH);
+        header.header.id = id;
+        header.asset_count = options.atlas_records;
+        header.image_id = image_id;
+
+        std::vector<u8> bytes;
+        bytes.reserve(damb::ATLS_HEADER_SIZE + static_cast<std::size_t>(options.atlas_records) * damb::ATLS_RECORD_SIZE);
+        amb::utility::appendPod(bytes, header);
+
+        for (u32 r = 0; r < options.atlas_records; r++) {
+            damb::AtlasRecord record {};
+            record.id = static_cast<u16>(r);
+            record.src_x = static_cast<u16>(std::min<u32>((r % columns) * tile_w, options.image_width - tile_w));
+            record.src_y = static_cast<u16>(std::min<u32>((r / columns) * tile_h, options.image_height - tile_h));
+            record.src_w = tile_w;
+            record.src_h = tile_h;
+            record.flags = damb::ATLS_RECORD_FLAG_OPAQUE;  // generated pixels are fully opaque
+            if (r >= 1 && r <= options.solid_records) {
+                record.flags |= damb::ATLS_RECORD_FLAG_SOLID;
+            }
+            amb::utility::appendPod(bytes, record);
+        }
+
+        return bytes;
+    }
+
+    // the first `animations` records each cycle through themselves and the next three records
+    std::vector<u8> buildAnimationChunk(const GeneratorOptions& options, u16 id) {
+        const u32 frames_per_animation = std::min<u32>(4, options.atlas_records);
+
+        damb::AnimationChunkHeader header {};
+        std::memcpy(header.header.type, damb::CL_ANIMATION, amb::data::CHUNK_TYPE_LENGTH);
+        header.header.id = id;
+        header.sequence_count = options.animations;
+        header.frame_count = options.animations * frames_per_animation;
+
+        std::vector<u8> bytes;
+        bytes.reserve(damb::ANIM_HEADER_SIZE
+            + static_cast<std::size_t>(header.sequence_count) * damb::ANIM_SEQUENCE_SIZE
+            + static_cast<std::size_t>(header.frame_count) * damb::ANIM_FRAME_SIZE);
+        amb::utility::appendPod(bytes, header);
+
+        for (u32 a = 0; a < options.animations; a++) {
+            damb::AnimationSequence sequence {};
+            sequence.atlas_record_index = static_cast<u16>(a);
+            sequence.frame_count = static_cast<u16>(frames_per_animation);
+            sequence.first_frame = a * frames_per_animation;
+            amb::utility::appendPod(bytes, sequence);
+        }
+
+        for (u32 a = 0; a < options.animations; a++) {
+            for (u32 f = 0; f < frames_per_animation; f++) {
+                damb::AnimationFrame frame {};
+                frame.atlas_record_index = static_cast<u16>((a + f) % options.atlas_records);
+                frame.duration_ms = 100 + 25 * (a % 4);
+                amb::utility::appendPod(bytes, frame);
+            }
+        }
+
+        return bytes;
+    }
+
+    std::vector<u8> buildEntityChunk(const GeneratorOptions& options, u16 id, u16 map_id, Random& random) {
+        damb::EntityChunkHeader header {};
+        std::memcpy(header.header.type, damb::CL_ENTITY, amb::data::CHUNK_TYPE_LENGTH);
+        header.header.id = id;
+        header.map_id = map_id;
+        header.entity_count = options.entities;
+
+        std::vector<u8> bytes;
+        bytes.reserve(damb::ENTS_HEADER_SIZE + static_cast<std::size_t>(options.entities) * damb::ENTS_RECORD_SIZE);
+        amb::utility::appendPod(bytes, header);
+
+        for (u32 e = 0; e < options.entities; e++) {
+            damb::EntityRecord record {};
+            record.id = static_cast<u16>(e);
+            record.type = damb::EntityType::npc;
+            record.tile_x = static_cast<u16>(random.below(options.map_width));
+            record.tile_y = static_cast<u16>(random.below(options.map_height));
+            record.heading = static_cast<float>(random.below(360));
+            record.speed = static_cast<float>(16 + random.below(112));
+            amb::utility::appendPod(bytes, record);
+        }
+
+        return bytes;
+    }
+
+    std::vector<damb::MapCell> generateCells(const GeneratorOptions& options, Random& random) {
+        const std::size_t cell_count = static_cast<std::size_t>(options.map_width) * options.map_height;
+        std::vector<damb::MapCell> cells(cell_count);
+
+        std::size_t run_left = 0;
+        u16 run_record = 0;
+        for (damb::MapCell& cell : cells) {
+            switch (options.pattern) {
+                case MapPattern::noise:
+                    cell.atlas_record_index = static_cast<u16>(random.below(options.atlas_records));
+                    break;
+                case MapPattern::runs:
+                    if (run_left == 0) {
+                        run_left = 1 + random.below(64);
+                        run_record = static_cast<u16>(random.below(options.atlas_records));
+                    }
+                    run_left--;
+                    cell.atlas_record_index = run_record;
+                    break;
+                case MapPattern::sparse:
+                    cell.atlas_record_index = (random.below(16) == 0) ? static_cast<u16>(random.below(options.atlas_records)) : 0;
+                    break;
+            }
+        }
+
+        return cells;
+    }
+
+    std::vector<u8> buildMapChunk(const GeneratorOptions& options, u16 id, u16 atlas_id, i32 z, Random& random) {
+        const std::vector<damb::MapCell> cells = generateCells(options, random);
+
+        damb::EncodedMapPayload encoded;
+        switch (options.encoding) {
+            case MapEncodingChoice::smallest:
+                encoded = damb::encodeSmallestCells(cells);
+                break;
+            case MapEncodingChoice::raw:
+                encoded = damb::encodeRawCells(cells);
+                break;
+            case MapEncodingChoice::run_length:
+                encoded = damb::encodeRunLengthCells(cells);
+                break;
+            case MapEncodingChoice::palette:
+                encoded = damb::encodePaletteCells(cells);
+                break;
+        }
+
+        damb::MapLayerChunkHeader header {};
+        std::memcpy(header.header.type, damb::CL_MAP_LAYER, amb::data::CHUNK_TYPE_LENGTH);
+        header.header.id = id;
+        header.width = options.map_width;
+        header.height = options.map_height;
+        header.z = z;
+        header.atlas_id = atlas_id;
+        header.encoding = encoded.encoding;
+
+        std::vector<u8> bytes;
+        bytes.reserve(damb::MAPL_HEADER_SIZE + encoded.bytes.size());
+        amb::utility::appendPod(bytes, header);
+        bytes.insert(bytes.end(), encoded.bytes.begin(), encoded.bytes.end());
+        return bytes;
+    }
+
+    void generate(const GeneratorOptions& options) {
+        Random random(options.seed);
+        DambStreamWriter writer(options.output_path);
+
+        // the loader resolves IMAG/ATLS dependencies only among chunks stored before each MAPL
+        for (u32 i = 0; i < options.image_count; i++) {
+            const u16 id = static_cast<u16>(i + 1);
+            writer.writeChunk(damb::CL_IMAGE, id, buildImageChunk(options, id, random), options.compression);
+            writer.writeChunk(damb::CL_ATLAS, id, buildAtlasChunk(options, id, id), options.compression);
+            if (options.animations > 0) {
+                writer.writeChunk(damb::CL_ANIMATION, id, buildAnimationChunk(options, id), options.compression);
+            }
+        }
+
+        for (u32 i = 0; i < options.layer_count; i++) {
+            const u16 id = static_cast<u16>(i + 1);
+            const u16 atlas_id = static_cast<u16>((i % options.image_count) + 1);
+            writer.writeChunk(
+                damb::CL_MAP_LAYER,
+                id,
+                buildMapChunk(options, id, atlas_id, static_cast<i32>(i), random),
+                options.compression);
+        }
+
+        if (options.entities > 0) {
+            writer.writeChunk(damb::CL_ENTITY, 1, buildEntityChunk(options, 1, 1, random), options.compression);
+        }
+
+        const u64 file_size = writer.finish();
+        std::cout << "Wrote " << options.output_path.string() << " (" << file_size << " bytes, "
+                  << options.image_count << " images, " << options.layer_count << " layers of "
+                  << options.map_width << "x" << options.map_height << ").\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    try {
+        generate(parseOptions(argc, argv));
+        return 0;
+    } catch (const std::invalid_argument&) {
+        printUsage(std::cout);
+        return 1;
+    } catch (const std::exception& ex) {
+        std::cerr << "damb_generate error: " << ex.what() << '\n';
+        return 1;
+    }
+}
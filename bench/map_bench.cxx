@@ -0,0 +1,285 @@
+#include "runtime_map.hxx"
+#include "utility_parse.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// times MapRuntime tile queries against the same map stored row-major and bricked; every query kind sums the
+// cells it reads, and both layouts must agree on the sums
+namespace {
+    using Clock = std::chrono::steady_clock;
+    using amb::runtime::CellLayout;
+
+    // a 1920x1080 view over 50 px tiles, plus the partial tiles at its edges
+    constexpr std::size_t VIEWPORT_TILES_X = 40;
+    constexpr std::size_t VIEWPORT_TILES_Y = 23;
+    // e.g. an AI or collision scan around a large ship
+    constexpr std::size_t REGION_TILES = 256;
+    constexpr std::size_t LINE_MAX_TILES = 512;
+
+    struct BenchOptions {
+        std::size_t map_width = 16384;
+        std::size_t map_height = 4096;
+        u32 queries = 20000;
+        u32 iterations = 5;
+        u32 seed = 1;
+    };
+
+    struct TileRect {
+        std::size_t min_tx = 0;
+        std::size_t min_ty = 0;
+        std::size_t max_tx = 0;
+        std::size_t max_ty = 0;
+    };
+
+    struct TilePoint {
+        std::size_t tile_x = 0;
+        std::size_t tile_y = 0;
+    };
+
+    struct TileLine {
+        TilePoint from;
+        TilePoint to;
+    };
+
+    struct QueryResult {
+        double ns_per_query = 0.0;
+        u64 checksum = 0;
+    };
+
+    void printUsage(std::ostream& out) {
+        out << "Usage:\n"
+            << "  map_bench [--map <w>x<h>] [--queries <n>] [--iterations <n>] [--seed <n>]\n";
+    }
+
+    BenchOptions parseOptions(int argc, char** argv) {
+        BenchOptions options;
+
+        for (int i = 1; i < argc; i += 2) {
+            const std::string option = argv[i];
+            if (option == "--help" || option == "-h") {
+                throw std::invalid_argument("usage requested");
+            }
+
+            if (i + 1 >= argc) {
+                throw std::runtime_error(option + " expects a value.");
+            }
+
+            const std::string value = argv[i + 1];
+            if (option == "--map") {
+                const std::size_t separator = value.find('x');
+                if (separator == std::string::npos) {
+                    throw std::runtime_error("--map expects <w>x<h>, got: " + value);
+                }
+                options.map_width = amb::utility::parseCount(value.substr(0, separator), option);
+                options.map_height = amb::utility::parseCount(value.substr(separator + 1), option);
+            } else if (option == "--queries") {
+                options.queries = std::max<u32>(1, amb::utility::parseCount(value, option));
+            } else if (option == "--iterations") {
+                options.iterations = std::max<u32>(1, amb::utility::parseCount(value, option));
+            } else if (option == "--seed") {
+                options.seed = amb::utility::parseCount(value, option);
+            } else {
+                throw std::runtime_error("Unknown option: " + option);
+            }
+        }
+
+        if (options.map_width < REGION_TILES || options.map_height < REGION_TILES) {
+            throw std::runtime_error("--map must be at least " + std::to_string(REGION_TILES) + " tiles on each side.");
+        }
+
+        return options;
+    }
+
+    MapRuntime buildMap(const BenchOptions& options) {
+        std::vector<Cell> cells(options.map_width * options.map_height);
+        u32 state = options.seed * 2654435761u + 1u;
+        for (Cell& cell : cells) {
+            state = state * 1664525u + 1013904223u;
+            cell = static_cast<Cell>(state >> 16);
+        }
+
+        return MapRuntime(options.map_width, options.map_height, std::move(cells));
+    }
+
+    u64 sumViewportTiles(const MapRuntime& map, const TileRect& rect) noexcept {
+        u64 sum = 0;
+        for (std::size_t tile_y = rect.min_ty; tile_y <= rect.max_ty; tile_y++) {
+            for (std::size_t tile_x = rect.min_tx; tile_x <= rect.max_tx; tile_x++) {
+                sum += *map.cellAtTile(tile_x, tile_y);
+            }
+        }
+        return sum;
+    }
+
+    u64 sumRuns(const MapRuntime& map, const TileRect& rect) noexcept {
+        u64 sum = 0;
+        MapRuntime::CellRunIterator runs = map.cellRuns(rect.min_tx, rect.min_ty, rect.max_tx, rect.max_ty);
+        for (amb::runtime::CellRun run; runs.next(run);) {
+            for (std::size_t i = 0; i < run.count; i++) {
+                sum += run.cells[i];
+            }
+        }
+        return sum;
+    }
+
+    // Bresenham walk, reading every tile the line passes
+    u64 sumLine(const MapRuntime& map, const TileLine& line) noexcept {
+        i64 x = static_cast<i64>(line.from.tile_x);
+        i64 y = static_cast<i64>(line.from.tile_y);
+        const i64 to_x = static_cast<i64>(line.to.tile_x);
+        const i64 to_y = static_cast<i64>(line.to.tile_y);
+        const i64 dx = std::abs(to_x - x);
+        const i64 dy = -std::abs(to_y - y);
+        const i64 step_x = (x < to_x) ? 1 : -1;
+        const i64 step_y = (y < to_y) ? 1 : -1;
+        i64 error = dx + dy;
+
+        u64 sum = 0;
+        while (true) {
+            sum += *map.cellAtTile(static_cast<std::size_t>(x), static_cast<std::size_t>(y));
+            if (x == to_x && y == to_y) {
+                break;
+            }
+
+            const i64 doubled = 2 * error;
+            if (doubled >= dy) {
+                error += dy;
+                x += step_x;
+            }
+            if (doubled <= dx) {
+                error += dx;
+                y += step_y;
+            }
+        }
+        return sum;
+    }
+
+    class MapBench {
+    public:
+        explicit MapBench(const BenchOptions& options)
+        : m_options(options),
+          m_row_major(buildMap(options)),
+          m_bricked(m_row_major) {
+            m_bricked.setLayout(CellLayout::bricked);
+
+            std::mt19937 rng(options.seed);
+            m_viewports = randomRects(rng, VIEWPORT_TILES_X, VIEWPORT_TILES_Y);
+            m_regions = randomRects(rng, REGION_TILES, REGION_TILES);
+
+            std::uniform_int_distribution<std::size_t> any_x(0, options.map_width - 1);
+            std::uniform_int_distribution<std::size_t> any_y(0, options.map_height - 1);
+            std::uniform_int_distribution<i64> offset(-static_cast<i64>(LINE_MAX_TILES), static_cast<i64>(LINE_MAX_TILES));
+            for (u32 i = 0; i < options.queries; i++) {
+                const TilePoint from {any_x(rng), any_y(rng)};
+                m_points.push_back(from);
+
+                const TilePoint to {
+                    clampTile(static_cast<i64>(from.tile_x) + offset(rng), options.map_width),
+                    clampTile(static_cast<i64>(from.tile_y) + offset(rng), options.map_height),
+                };
+                m_lines.push_back(TileLine {from, to});
+            }
+        }
+
+        void run(std::ostream& out) const {
+            out << "map " << m_options.map_width << "x" << m_options.map_height << ", " << m_options.queries
+                << " queries per kind, best of " << m_options.iterations << " iterations, "
+                << amb::runtime::MAP_BRICK_TILES << "x" << amb::runtime::MAP_BRICK_TILES << " bricks\n";
+            out << std::left << std::setw(22) << "query" << std::right
+                << std::setw(16) << "row-major ns" << std::setw(14) << "bricked ns" << std::setw(10) << "speedup" << '\n';
+
+            report(out, "viewport cellAtTile", [](const MapRuntime& map, const TileRect& rect) { return sumViewportTiles(map, rect); }, m_viewports);
+            report(out, "viewport cellRuns", [](const MapRuntime& map, const TileRect& rect) { return sumRuns(map, rect); }, m_viewports);
+            report(out, "region 256 cellRuns", [](const MapRuntime& map, const TileRect& rect) { return sumRuns(map, rect); }, m_regions);
+            report(out, "random point", [](const MapRuntime& map, const TilePoint& point) { return static_cast<u64>(*map.cellAtTile(point.tile_x, point.tile_y)); }, m_points);
+            report(out, "line", [](const MapRuntime& map, const TileLine& line) { return sumLine(map, line); }, m_lines);
+        }
+
+    private:
+        static std::size_t clampTile(i64 tile, std::size_t limit) noexcept {
+            return static_cast<std::size_t>(std::clamp<i64>(tile, 0, static_cast<i64>(limit) - 1));
+        }
+
+        std::vector<TileRect> randomRects(std::mt19937& rng, std::size_t width, std::size_t height) const {
+            std::uniform_int_distribution<std::size_t> left(0, m_options.map_width - width);
+            std::uniform_int_distribution<std::size_t> top(0, m_options.map_height - height);
+
+            std::vector<TileRect> rects;
+            rects.reserve(m_options.queries);
+            for (u32 i = 0; i < m_options.queries; i++) {
+                const std::size_t min_tx = left(rng);
+                const std::size_t min_ty = top(rng);
+                rects.push_back(TileRect {min_tx, min_ty, min_tx + width - 1, min_ty + height - 1});
+            }
+            return rects;
+        }
+
+        template <typename Query, typename Input>
+        QueryResult time(const MapRuntime& map, Query query, const std::vector<Input>& inputs) const {
+            QueryResult result;
+            result.ns_per_query = std::numeric_limits<double>::max();
+
+            for (u32 iteration = 0; iteration < m_options.iterations; iteration++) {
+                u64 checksum = 0;
+                const Clock::time_point start = Clock::now();
+                for (const Input& input : inputs) {
+                    checksum += query(map, input);
+                }
+                const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+                result.ns_per_query = std::min(result.ns_per_query, ns / static_cast<double>(inputs.size()));
+                result.checksum = checksum;
+            }
+
+            return result;
+        }
+
+        template <typename Query, typename Input>
+        void report(std::ostream& out, const char* name, Query query, const std::vector<Input>& inputs) const {
+            const QueryResult row_major = time(m_row_major, query, inputs);
+            const QueryResult bricked = time(m_bricked, query, inputs);
+            if (row_major.checksum != bricked.checksum) {
+                throw std::runtime_error(std::string(name) + ": layouts read different cells.");
+            }
+
+            out << std::left << std::setw(22) << name << std::right << std::fixed << std::setprecision(1)
+                << std::setw(16) << row_major.ns_per_query
+                << std::setw(14) << bricked.ns_per_query
+                << std::setprecision(2) << std::setw(9) << (row_major.ns_per_query / bricked.ns_per_query) << "x\n";
+        }
+
+        const BenchOptions& m_options;
+        MapRuntime m_row_major;
+        MapRuntime m_bricked;
+        std::vector<TileRect> m_viewports;
+        std::vector<TileRect> m_regions;
+        std::vector<TilePoint> m_points;
+        std::vector<TileLine> m_lines;
+    };
+}
+
+int main(int argc, char** argv) {
+    try {
+        const BenchOptions options = parseOptions(argc, argv);
+        MapBench bench(options);
+        bench.run(std::cout);
+        return 0;
+    } catch (const std::invalid_argument&) {
+        printUsage(std::cout);
+        return 1;
+    } catch (const std::exception& ex) {
+        std::cerr << "map_bench error: " << ex.what() << '\n';
+        return 1;
+    }
+}
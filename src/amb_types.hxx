@@ -10,13 +10,19 @@ typedef std::uint8_t u8;
 typedef std::uint16_t u16;
 typedef std::uint32_t u32;
 typedef std::uint64_t u64;
+typedef std::int8_t i8;
 typedef std::int16_t i16;
 typedef std::int32_t i32;
+typedef std::int64_t i64;
 
 struct TextureDeleter {
     void operator()(SDL_Texture* t) const noexcept { if (t) SDL_DestroyTexture(t); }
 };
 
+struct SurfaceDeleter {
+    void operator()(SDL_Surface* s) const noexcept { if (s) SDL_DestroySurface(s); }
+};
+
 struct WindowDeleter {
     void operator()(SDL_Window* w) const noexcept { if (w) SDL_DestroyWindow(w); }
 };
@@ -28,6 +34,7 @@ struct RendererDeleter {
 using WindowPtr = std::unique_ptr<SDL_Window, WindowDeleter>;
 using RendererPtr = std::unique_ptr<SDL_Renderer, RendererDeleter>;
 using TexturePtr = std::unique_ptr<SDL_Texture, TextureDeleter>;
+using SurfacePtr = std::unique_ptr<SDL_Surface, SurfaceDeleter>;
 using Cell = u16;
 
 #endif
@@ -2,6 +2,7 @@
 #include "config.hxx"
 
 #include <algorithm>
+#include <cmath>
 #include <stdexcept>
 
 Ambassador::Ambassador() {
@@ -11,10 +12,29 @@ Ambassador::Ambassador() {
         amb::config::APP_IDENTIFIER
     );
 
-    m_lasttick = SDL_GetTicks();
+    AMB_PROFILE_THREAD("main");
+    m_timestep.reset(SDL_GetTicksNS());
+    m_loader.setResourceCache(&m_resource_cache);
+    m_loader.setCellLayout(amb::config::MAP_CELLS_BRICKED ? amb::runtime::CellLayout::bricked : amb::runtime::CellLayout::row_major);
 }
 
-Ambassador::~Ambassador() = default;
+Ambassador::~Ambassador() {
+    if (amb::config::PROFILE_TRACE_AT_EXIT) {
+        dumpTrace();
+    }
+}
+
+void Ambassador::dumpTrace() const {
+#if defined(AMB_PROFILING)
+    if (amb::utility::profile::writeChromeTrace(amb::config::PROFILE_TRACE_PATH)) {
+        SDL_Log("Wrote profiler trace: %s", amb::config::PROFILE_TRACE_PATH);
+    } else {
+        SDL_Log("Failed to write profiler trace: %s", amb::config::PROFILE_TRACE_PATH);
+    }
+#else
+    SDL_Log("Profiler trace unavailable: built without AMB_PROFILING");
+#endif
+}
 
 SDL_AppResult Ambassador::bootstrap() {
     if (m_bootstrapped) {
@@ -57,17 +77,54 @@ SDL_AppResult Ambassador::bootstrap() {
     }
 
     configureViewportGrid(amb::config::DEFAULT_APP_WIDTH, amb::config::DEFAULT_APP_HEIGHT);
+    m_camera.setViewportSize(amb::config::DEFAULT_APP_WIDTH, amb::config::DEFAULT_APP_HEIGHT);
+    m_previous_camera = m_camera;
 
     m_bootstrapped = true;
     return checkInit();
 }
 
-SDL_AppResult Ambassador::checkInit() const {
-    return (m_initErrors) ? SDL_APP_FAILURE : SDL_APP_CONTINUE;
+SDL_AppResult Ambassador::bootstrapHeadless() {
+    if (m_bootstrapped) {
+        return checkInit();
+    }
+
+    // an explicit SDL_VIDEO_DRIVER in the environment still wins over this hint
+    SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+    if (!SDL_Init(SDL_INIT_VIDEO)) {
+        m_initErrors = true;
+        SDL_Log("Video Initialization Error: %s", SDL_GetError());
+    }
+
+    if (!m_initErrors) {
+        m_headless_target.reset(SDL_CreateSurface(
+            amb::config::DEFAULT_APP_WIDTH,
+            amb::config::DEFAULT_APP_HEIGHT,
+            SDL_PIXELFORMAT_ABGR8888));
+        if (m_headless_target == nullptr) {
+            m_initErrors = true;
+            SDL_Log("Headless target creation failed: %s", SDL_GetError());
+        }
+    }
+
+    if (!m_initErrors) {
+        m_renderer.reset(SDL_CreateSoftwareRenderer(m_headless_target.get()));
+        if (m_renderer == nullptr) {
+            m_initErrors = true;
+            SDL_Log("Software renderer creation failed: %s", SDL_GetError());
+        }
+    }
+
+    configureViewportGrid(amb::config::DEFAULT_APP_WIDTH, amb::config::DEFAULT_APP_HEIGHT);
+    m_camera.setViewportSize(amb::config::DEFAULT_APP_WIDTH, amb::config::DEFAULT_APP_HEIGHT);
+    m_previous_camera = m_camera;
+
+    m_bootstrapped = true;
+    return checkInit();
 }
 
-bool Ambassador::needUpdate(u64 now) {
-    return (last() + amb::config::UPDATE_SPEED <= now);
+SDL_AppResult Ambassador::checkInit() const {
+    return (m_initErrors) ? SDL_APP_FAILURE : SDL_APP_CONTINUE;
 }
 
 void Ambassador::configureViewportGrid(int width, int height) {
@@ -107,13 +164,99 @@ SDL_AppResult Ambassador::loadSandbox(const std::filesystem::path& file_path) {
     }
 
     try {
+        // layers of the previous level release their images and atlases; what fits the budget stays cached
         m_layers.clear();
-        m_layers.emplace_back(m_loader.loadMapLayer(renderer(), file_path));
+        m_entities.clear();
+        m_entity_grid.clear();
+        m_visible_entities.visible_count = 0;
+        m_resource_cache.trim();
+        m_camera_placed = false;
+        m_preloader.start(file_path);
     } catch (const std::exception& ex) {
         SDL_Log("Failed to load DAMB file %s: %s", file_path.string().c_str(), ex.what());
         return SDL_APP_FAILURE;
     }
 
-    SDL_Log("Loaded DAMB sandbox file: %s", file_path.string().c_str());
+    SDL_Log("Loading DAMB sandbox file: %s", file_path.string().c_str());
+    return SDL_APP_CONTINUE;
+}
+
+SDL_AppResult Ambassador::pumpPreloader() {
+    if (!m_preloader.active()) {
+        return SDL_APP_CONTINUE;
+    }
+
+    try {
+        const std::size_t layer_count = m_layers.size();
+        const bool pending = m_preloader.pump(renderer(), amb::config::PRELOAD_UPLOAD_BUDGET_NS, m_layers);
+        if (m_layers.size() != layer_count || !pending) {
+            arrangeLayers(!pending);
+        }
+        fitCameraToLayers();
+        if (!pending) {
+            m_entities = m_preloader.takeEntities();
+            resetEntityGrid();
+            SDL_Log("Loaded DAMB sandbox file: %s (%zu entities)", m_preloader.path().string().c_str(), m_entities.size());
+        }
+    } catch (const std::exception& ex) {
+        SDL_Log("Failed to load DAMB file %s: %s", m_preloader.path().string().c_str(), ex.what());
+        return SDL_APP_FAILURE;
+    }
+
     return SDL_APP_CONTINUE;
 }
+
+// the grid spans the entity bounds, which the loader sets to the largest map the entities spawn on
+void Ambassador::resetEntityGrid() {
+    const float tile_size = static_cast<float>(amb::game::MAP_TILE_SIZE);
+    m_entity_grid.reset(
+        static_cast<std::size_t>(std::ceil(m_entities.boundsWidth() / tile_size)),
+        static_cast<std::size_t>(std::ceil(m_entities.boundsHeight() / tile_size)),
+        amb::config::ENTITY_GRID_CELL_TILES);
+    m_entity_grid.update(m_entities);
+    m_visible_entities.slots.assign(m_entities.size(), 0);
+    m_visible_entities.visible_count = 0;
+}
+
+// bounds follow the largest map loaded so far; the first map layer's spawn point becomes the start position
+void Ambassador::fitCameraToLayers() {
+    float bounds_w = 0.0f;
+    float bounds_h = 0.0f;
+    const MapLayer* first_map = nullptr;
+
+    for (const auto& layer : m_layers) {
+        const auto* map_layer = dynamic_cast<const MapLayer*>(layer.get());
+        if (map_layer == nullptr) {
+            continue;
+        }
+
+        if (first_map == nullptr) {
+            first_map = map_layer;
+        }
+
+        bounds_w = std::max(bounds_w, static_cast<float>(map_layer->map().width() * amb::game::MAP_TILE_SIZE));
+        bounds_h = std::max(bounds_h, static_cast<float>(map_layer->map().height() * amb::game::MAP_TILE_SIZE));
+    }
+
+    m_camera.setBounds(bounds_w, bounds_h);
+
+    if (!m_camera_placed && first_map != nullptr) {
+        const amb::runtime::SpawnPoint& spawn = first_map->spawnPoint();
+        m_camera.setPosition(spawn.world_x, spawn.world_y);
+        m_camera_placed = true;
+    }
+
+    // placement and clamping are jumps, not motion to interpolate
+    m_previous_camera = m_camera;
+}
+
+// layers draw in ascending MAPL z as they stream in; occlusion needs the whole stack, so it waits for the last layer
+void Ambassador::arrangeLayers(const bool loading_done) {
+    std::stable_sort(m_layers.begin(), m_layers.end(), [](const VisualLayerPtr& lhs, const VisualLayerPtr& rhs) {
+        return lhs->z() < rhs->z();
+    });
+
+    if (loading_done) {
+        composeLayerOcclusion(m_layers);
+    }
+}
@@ -2,7 +2,17 @@
 #define AMBASSADOR_HXX_INCLUDED
 
 #include "amb_types.hxx"
+#include "config.hxx"
 #include "damb_loader.hxx"
+#include "damb_preloader.hxx"
+#include "entity_grid.hxx"
+#include "entity_store.hxx"
+#include "frame_graph.hxx"
+#include "resource_cache.hxx"
+#include "runtime_camera.hxx"
+#include "runtime_timestep.hxx"
+#include "render_bench.hxx"
+#include "utility_histogram.hxx"
 
 #include <SDL3/SDL.h>
 
@@ -19,34 +29,91 @@ public:
     SDL_Renderer* renderer() const noexcept { return m_renderer.get(); }
 
     SDL_AppResult bootstrap();
+    // no window: renders into an offscreen software surface, for benchmarks and automation
+    SDL_AppResult bootstrapHeadless();
     SDL_AppResult checkInit() const;
 
-    u64 last() { return m_lasttick; }
-
-    bool needUpdate(u64 now);
-
     SDL_AppResult event(SDL_Event* event);
     SDL_AppResult loop();
-    void update(u64 now);
-    SDL_AppResult render();
+    void update();
+    // `alpha` in [0, 1) places the frame between the previous and the current update
+    SDL_AppResult render(float alpha);
     SDL_AppResult loadSandbox(const std::filesystem::path& file_path);
+    SDL_AppResult pumpPreloader();
+    // writes the profiler's retained events to PROFILE_TRACE_PATH
+    void dumpTrace() const;
+    // loads `options.damb_path` synchronously, renders the scripted camera path and prints the report
+    SDL_AppResult runRenderBench(const RenderBenchOptions& options);
 
     void configureViewportGrid(int width, int height);
     SDL_Rect layerViewportFor(const VisualLayer& layer) const;
+
+    Camera& camera() noexcept { return m_camera; }
+    const Camera& camera() const noexcept { return m_camera; }
+    const FixedTimestep& timestep() const noexcept { return m_timestep; }
+    // layer draw calls and tiles summed over the latest render()
+    const amb::runtime::LayerRenderStats& frameRenderStats() const noexcept { return m_frame_render_stats; }
+    // event-to-present latency of input over the latest full INPUT_LATENCY_LOG_INTERVAL_NS window
+    const amb::utility::DurationHistogram& inputLatency() const noexcept { return m_last_input_latency; }
+    // entities of the loaded sandbox file, advanced once per fixed step
+    const amb::entity::EntityStore& entities() const noexcept { return m_entities; }
+    // entity slots inside the camera's view as of the latest update
+    const amb::entity::EntityView& visibleEntities() const noexcept { return m_visible_entities; }
+    // forces the next iteration to render with RENDER_ON_DEMAND; for state the frame check cannot see
+    void markFrameDirty() noexcept { m_frame_dirty = true; }
 private:
+    void updateCamera();
+    void fitCameraToLayers();
+    void resetEntityGrid();
+    void arrangeLayers(bool loading_done);
+    // closes the latency of input the presented frame reflects; logs and rolls the window every interval
+    void recordInputLatency(u64 present_ns);
+    bool frameDirty(float alpha) const;
+    void waitForWork();
+
+    // the headless target must outlive the software renderer drawing into it
+    SurfacePtr m_headless_target;
     WindowPtr m_window;
     RendererPtr m_renderer;
 
     bool m_bootstrapped = false;
     bool m_initErrors = false;
     bool m_running = true;
-    u64 m_lasttick = 0;
+
+    FixedTimestep m_timestep {amb::config::UPDATE_STEP_NS, amb::config::MAX_UPDATE_STEPS_PER_FRAME};
+    u64 m_update_count = 0;
+    u64 m_update_time_ms = 0;  // simulated time after m_update_count steps
 
     int m_viewport_row_sz;
     int m_viewport_col_sz;
 
+    // moved by update(), read by render(); zoom steps queue up from input events until the next tick
+    Camera m_camera;
+    Camera m_previous_camera;  // state before the latest update, the interpolation start
+    Camera m_rendered_camera;  // interpolated camera of the frame on screen
+    bool m_frame_dirty = true;
+    amb::runtime::LayerRenderStats m_frame_render_stats {};
+    FrameGraphOverlay m_frame_graph;  // toggled with F3
+    float m_pending_zoom_steps = 0.0f;
+    // SDL timestamps of input events: pending until an update consumes them, applied until the next present
+    std::vector<u64> m_input_pending_ns;
+    std::vector<u64> m_input_applied_ns;
+    amb::utility::DurationHistogram m_input_latency;
+    amb::utility::DurationHistogram m_last_input_latency;
+    u64 m_input_latency_window_ns = 0;  // start of the current window
+    bool m_camera_placed = false;
+
+    ResourceCache m_resource_cache {ResourceCache::Budget {
+        amb::config::RESOURCE_CACHE_GPU_BUDGET,
+        amb::config::RESOURCE_CACHE_CPU_BUDGET,
+    }};
     DambLoader m_loader;
     std::vector<VisualLayerPtr> m_layers;
+    amb::entity::EntityStore m_entities;
+    amb::entity::SpatialGrid m_entity_grid;
+    amb::entity::EntityView m_visible_entities;
+    // declared last so its worker threads are joined before anything else is torn down
+    DambPreloader m_preloader {m_loader, amb::config::PRELOAD_WORKER_COUNT};
 };
 
 
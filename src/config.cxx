@@ -7,8 +7,41 @@ const char* amb::config::APP_IDENTIFIER = "io.scavengers.ambassador";
 const int amb::config::DEFAULT_APP_WIDTH = 1920;
 const int amb::config::DEFAULT_APP_HEIGHT = 1080;
 
-const u64 amb::config::GAME_SPEED = 60;
-const u64 amb::config::UPDATE_SPEED = 1000 / GAME_SPEED;
+// fixed update rate in Hz; rendering is uncapped and interpolates between updates
+const u64 amb::config::GAME_SPEED = 120;
+const u64 amb::config::UPDATE_STEP_NS = 1'000'000'000 / GAME_SPEED;
+// catch-up cap: a frame runs at most this many updates and drops the rest of its backlog
+const u32 amb::config::MAX_UPDATE_STEPS_PER_FRAME = 5;
+
+const u32 amb::config::PRELOAD_WORKER_COUNT = 4;
+// texture uploads per frame stop once this much of the frame is spent (at least one per frame)
+const u64 amb::config::PRELOAD_UPLOAD_BUDGET_NS = 4'000'000;
+
+// unreferenced textures and atlas tables stay resident for level switches until these are exceeded
+const std::size_t amb::config::RESOURCE_CACHE_GPU_BUDGET = 256u * 1024u * 1024u;
+const std::size_t amb::config::RESOURCE_CACHE_CPU_BUDGET = 16u * 1024u * 1024u;
+
+// frames are only rendered when the camera, a layer or the overlay changed; the loop sleeps otherwise
+const bool amb::config::RENDER_ON_DEMAND = true;
+
+// static map layers draw from a scrolling render target instead of re-drawing every visible tile
+const bool amb::config::MAP_LAYER_RENDER_CACHE = true;
+// map cells stored in 16x16 bricks instead of rows; see bench/map_bench for when that pays off
+const bool amb::config::MAP_CELLS_BRICKED = false;
+
+// spatial grid cell edge in map tiles; entity queries visit only the cells they overlap
+const std::size_t amb::config::ENTITY_GRID_CELL_TILES = 8;
+
+// screen pixels per second while a scroll key is held, and the zoom factor of one wheel notch or +/- press
+const float amb::config::CAMERA_SCROLL_SPEED = 900.0f;
+const float amb::config::CAMERA_ZOOM_STEP = 1.25f;
+
+// Chrome trace written on F4, and on exit when enabled; only filled in builds with AMB_PROFILING
+const char* amb::config::PROFILE_TRACE_PATH = "ambassador_trace.json";
+const bool amb::config::PROFILE_TRACE_AT_EXIT = false;
+
+// input-to-present latency percentiles are logged once per this interval
+const u64 amb::config::INPUT_LATENCY_LOG_INTERVAL_NS = 5'000'000'000;
 
 const u8 amb::game::MAP_TILE_SIZE = 50;
 
@@ -3,6 +3,8 @@
 
 #include "amb_types.hxx"
 
+#include <cstddef>
+
 namespace amb {
 namespace config {
     extern const char* APP_TITLE;
@@ -13,7 +15,27 @@ namespace config {
     extern const int DEFAULT_APP_HEIGHT;
 
     extern const u64 GAME_SPEED;
-    extern const u64 UPDATE_SPEED;
+    extern const u64 UPDATE_STEP_NS;
+    extern const u32 MAX_UPDATE_STEPS_PER_FRAME;
+
+    extern const u32 PRELOAD_WORKER_COUNT;
+    extern const u64 PRELOAD_UPLOAD_BUDGET_NS;
+
+    extern const std::size_t RESOURCE_CACHE_GPU_BUDGET;
+    extern const std::size_t RESOURCE_CACHE_CPU_BUDGET;
+
+    extern const bool MAP_LAYER_RENDER_CACHE;
+    extern const bool MAP_CELLS_BRICKED;
+    extern const bool RENDER_ON_DEMAND;
+
+    extern const std::size_t ENTITY_GRID_CELL_TILES;
+
+    extern const float CAMERA_SCROLL_SPEED;
+    extern const float CAMERA_ZOOM_STEP;
+
+    extern const char* PROFILE_TRACE_PATH;
+    extern const bool PROFILE_TRACE_AT_EXIT;
+    extern const u64 INPUT_LATENCY_LOG_INTERVAL_NS;
 }
 
 namespace game {
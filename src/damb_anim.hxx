@@ -0,0 +1,42 @@
+#ifndef DAMB_ANIM_HXX_INCLUDED
+#define DAMB_ANIM_HXX_INCLUDED
+
+#include "damb_format.hxx"
+
+#include <type_traits>
+
+namespace amb::damb {
+    constexpr u16 ANIM_HEADER_SIZE = 16;
+    constexpr u16 ANIM_SEQUENCE_SIZE = 8;
+    constexpr u16 ANIM_FRAME_SIZE = 8;
+
+    // cells holding `atlas_record_index` cycle through frames [first_frame, first_frame + frame_count)
+    struct AnimationSequence {
+        u16 atlas_record_index = 0;
+        u16 frame_count = 0;
+        u32 first_frame = 0;
+    };
+    static_assert(sizeof(AnimationSequence) == ANIM_SEQUENCE_SIZE, "AnimationSequence size does not match stated value.");
+    static_assert(std::is_trivially_copyable_v<AnimationSequence>, "AnimationSequence must be POD/trivially copyable.");
+
+    struct AnimationFrame {
+        u16 atlas_record_index = 0;
+        u16 reserved = 0;
+        u32 duration_ms = 0;
+    };
+    static_assert(sizeof(AnimationFrame) == ANIM_FRAME_SIZE, "AnimationFrame size does not match stated value.");
+    static_assert(std::is_trivially_copyable_v<AnimationFrame>, "AnimationFrame must be POD/trivially copyable.");
+
+    // an ANIM chunk extends the ATLS chunk with the same id and is stored after it; payload: AnimationSequence[sequence_count],
+    // then AnimationFrame[frame_count]
+    struct AnimationChunkHeader {
+        ChunkHeader header;
+        u16 reserved = 0;
+        u32 sequence_count = 0;
+        u32 frame_count = 0;
+    };
+    static_assert(sizeof(AnimationChunkHeader) == ANIM_HEADER_SIZE, "AnimationChunkHeader size does not match stated value.");
+    static_assert(std::is_trivially_copyable_v<AnimationChunkHeader>, "AnimationChunkHeader must be POD/trivially copyable.");
+}
+
+#endif
@@ -9,6 +9,11 @@ namespace amb::damb {
     constexpr u16 ATLS_RECORD_SIZE = 24;
     constexpr u16 ATLS_HEADER_SIZE = 20;
 
+    // AtlasRecord::flags: every pixel of the rect has full alpha, so the tile hides whatever is below it
+    constexpr u32 ATLS_RECORD_FLAG_OPAQUE = 1u << 0;
+    // AtlasRecord::flags: map cells using this record block movement; set by the manifest, not derived
+    constexpr u32 ATLS_RECORD_FLAG_SOLID = 1u << 1;
+
     struct AtlasRecord {
         u16 id = 0;
         u16 src_x = 0;
@@ -0,0 +1,47 @@
+#ifndef DAMB_ENTS_HXX_INCLUDED
+#define DAMB_ENTS_HXX_INCLUDED
+
+#include "damb_format.hxx"
+
+#include <type_traits>
+
+namespace amb::damb {
+    constexpr u16 ENTS_HEADER_SIZE = 16;
+    constexpr u16 ENTS_RECORD_SIZE = 16;
+
+    enum class EntityType : u8 {
+        player = 0,
+        npc = 1,
+    };
+
+    // EntityRecord::flags: the entity keeps its heading and speed but does not move
+    constexpr u8 ENTS_RECORD_FLAG_FROZEN = 1u << 0;
+    constexpr u8 ENTS_RECORD_FLAG_MASK = ENTS_RECORD_FLAG_FROZEN;
+
+    // spawns on the centre of cell (tile_x, tile_y); heading in degrees (0 = up, clockwise),
+    // speed in world pixels per second
+    struct EntityRecord {
+        u16 id = 0;
+        EntityType type = EntityType::npc;
+        u8 flags = 0;
+        u16 tile_x = 0;
+        u16 tile_y = 0;
+        float heading = 0.0f;
+        float speed = 0.0f;
+    };
+    static_assert(sizeof(EntityRecord) == ENTS_RECORD_SIZE, "EntityRecord size does not match stated value.");
+    static_assert(std::is_trivially_copyable_v<EntityRecord>, "EntityRecord must be POD/trivially copyable.");
+
+    // places entities on the MAPL chunk `map_id`, which must be stored before the ENTS chunk;
+    // payload: EntityRecord[entity_count]. ids are unique across every ENTS chunk of a file
+    struct EntityChunkHeader {
+        ChunkHeader header;
+        u16 map_id = 0;
+        u32 entity_count = 0;
+        u8 reserved[4] = {};
+    };
+    static_assert(sizeof(EntityChunkHeader) == ENTS_HEADER_SIZE, "EntityChunkHeader size does not match stated value.");
+    static_assert(std::is_trivially_copyable_v<EntityChunkHeader>, "EntityChunkHeader must be POD/trivially copyable.");
+}
+
+#endif
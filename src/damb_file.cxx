@@ -0,0 +1,313 @@
+#include "damb_file.hxx"
+
+#include "utility_crc.hxx"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+#if defined(_WIN32)
+#include <fstream>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    namespace damb = amb::damb;
+
+    u32 chunkTypeKey(const char* type) noexcept {
+        u32 key = 0;
+        std::memcpy(&key, type, amb::data::CHUNK_TYPE_LENGTH);
+        return key;
+    }
+}
+
+DambFile::DambFile(const std::filesystem::path& file_path)
+: m_path(file_path) {
+    map();
+
+    try {
+        m_header = amb::utility::readPod<damb::Header>(bytes(), 0, "file header");
+        validateHeader();
+        validateToc();
+        buildTocIndex();
+        m_chunk_verified = std::vector<std::atomic<bool>>(m_toc.size());
+    } catch (...) {
+        unmap();
+        throw;
+    }
+}
+
+DambFile::~DambFile() {
+    unmap();
+}
+
+DambFile::DambFile(DambFile&& other) noexcept
+: m_path(std::move(other.m_path)),
+  m_data(std::exchange(other.m_data, nullptr)),
+  m_size(std::exchange(other.m_size, 0)),
+  m_header(other.m_header),
+  m_toc(std::exchange(other.m_toc, {})),
+  m_toc_index(std::move(other.m_toc_index)),
+  m_chunk_verified(std::move(other.m_chunk_verified)) {}
+
+DambFile& DambFile::operator=(DambFile&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        m_path = std::move(other.m_path);
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+        m_header = other.m_header;
+        m_toc = std::exchange(other.m_toc, {});
+        m_toc_index = std::move(other.m_toc_index);
+        m_chunk_verified = std::move(other.m_chunk_verified);
+    }
+
+    return *this;
+}
+
+#if defined(_WIN32)
+// no mmap path on this platform yet; read the whole file once instead
+void DambFile::map() {
+    std::ifstream stream(m_path, std::ios::binary | std::ios::ate);
+    if (!stream.is_open()) {
+        throw std::runtime_error("Unable to open file: " + m_path.string());
+    }
+
+    const std::streamoff size = stream.tellg();
+    if (size <= 0) {
+        throw std::runtime_error("DAMB file is empty: " + m_path.string());
+    }
+    stream.seekg(0, std::ios::beg);
+
+    u8* buffer = new u8[static_cast<std::size_t>(size)];
+    stream.read(reinterpret_cast<char*>(buffer), static_cast<std::streamsize>(size));
+    if (!stream) {
+        delete[] buffer;
+        throw std::runtime_error("Failed to read file: " + m_path.string());
+    }
+
+    m_data = buffer;
+    m_size = static_cast<std::size_t>(size);
+}
+
+void DambFile::unmap() noexcept {
+    delete[] m_data;
+    m_data = nullptr;
+    m_size = 0;
+}
+#else
+void DambFile::map() {
+    const int fd = ::open(m_path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Unable to open file: " + m_path.string());
+    }
+
+    struct stat file_stat {};
+    if (::fstat(fd, &file_stat) != 0) {
+        const std::string reason = std::strerror(errno);
+        ::close(fd);
+        throw std::runtime_error("Unable to stat file " + m_path.string() + ": " + reason);
+    }
+
+    if (file_stat.st_size <= 0) {
+        ::close(fd);
+        throw std::runtime_error("DAMB file is empty: " + m_path.string());
+    }
+
+    const std::size_t size = static_cast<std::size_t>(file_stat.st_size);
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    const std::string reason = (mapping == MAP_FAILED) ? std::strerror(errno) : "";
+    ::close(fd);
+
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Unable to map file " + m_path.string() + ": " + reason);
+    }
+
+    m_data = static_cast<const u8*>(mapping);
+    m_size = size;
+}
+
+void DambFile::unmap() noexcept {
+    if (m_data != nullptr) {
+        ::munmap(const_cast<u8*>(m_data), m_size);
+    }
+
+    m_data = nullptr;
+    m_size = 0;
+}
+#endif
+
+void DambFile::validateHeader() const {
+    if (std::memcmp(m_header.magic, damb::MAGIC, amb::data::MAGIC_LENGTH) != 0) {
+        throw std::runtime_error("Invalid DAMB magic value.");
+    }
+
+    if (m_header.version != damb::VERSION) {
+        throw std::runtime_error("Unsupported DAMB version.");
+    }
+
+    if (m_header.toc_entry_size != damb::TOC_ENTRY_SIZE) {
+        throw std::runtime_error("Unexpected TOC entry size.");
+    }
+
+    if (m_header.file_size != static_cast<u64>(m_size)) {
+        throw std::runtime_error("DAMB header file_size does not match file size on disk.");
+    }
+}
+
+void DambFile::validateToc() {
+    m_toc = amb::utility::viewPodArray<damb::TocEntry>(bytes(), m_header.toc_offset, m_header.toc_count, "TOC");
+
+    for (const damb::TocEntry& entry : m_toc) {
+        if (entry.offset < damb::HEADER_SIZE) {
+            throw std::runtime_error("TOC entry offset overlaps the file header.");
+        }
+
+        // throws on chunks that run past the end of the file
+        chunkBytes(entry);
+    }
+}
+
+amb::utility::ByteSpan DambFile::chunkBytes(const damb::TocEntry& entry) const {
+    return bytes().subspan(entry.offset, entry.size, std::string(entry.type, amb::data::CHUNK_TYPE_LENGTH) + " chunk");
+}
+
+void DambFile::buildTocIndex() {
+    m_toc_index.clear();
+    m_toc_index.reserve(m_toc.size());
+
+    for (std::size_t i = 0; i < m_toc.size(); i++) {
+        m_toc_index.push_back(TocIndexEntry {
+            chunkTypeKey(m_toc[i].type),
+            m_toc[i].id,
+            static_cast<u32>(i),
+        });
+    }
+
+    std::sort(m_toc_index.begin(), m_toc_index.end(), [](const TocIndexEntry& a, const TocIndexEntry& b) {
+        return (a.type_key != b.type_key) ? a.type_key < b.type_key : a.id < b.id;
+    });
+
+    const auto duplicate = std::adjacent_find(m_toc_index.begin(), m_toc_index.end(), [](const TocIndexEntry& a, const TocIndexEntry& b) {
+        return a.type_key == b.type_key && a.id == b.id;
+    });
+    if (duplicate != m_toc_index.end()) {
+        const damb::TocEntry& entry = m_toc[duplicate->toc_position];
+        throw std::runtime_error(
+            "Duplicate TOC entry for " + std::string(entry.type, amb::data::CHUNK_TYPE_LENGTH) +
+            " id=" + std::to_string(entry.id) + ".");
+    }
+}
+
+const damb::TocEntry* DambFile::findChunk(const char* type, const u16 id) const noexcept {
+    const u32 type_key = chunkTypeKey(type);
+
+    const auto it = std::lower_bound(m_toc_index.begin(), m_toc_index.end(), type_key, [id](const TocIndexEntry& entry, const u32 key) {
+        return (entry.type_key != key) ? entry.type_key < key : entry.id < id;
+    });
+
+    if (it == m_toc_index.end() || it->type_key != type_key || it->id != id) {
+        return nullptr;
+    }
+
+    return &m_toc[it->toc_position];
+}
+
+std::vector<const damb::TocEntry*> DambFile::chunksOfType(const char* type) const {
+    const u32 type_key = chunkTypeKey(type);
+
+    const auto [first, last] = std::equal_range(
+        m_toc_index.begin(),
+        m_toc_index.end(),
+        TocIndexEntry { type_key, 0, 0 },
+        [](const TocIndexEntry& a, const TocIndexEntry& b) { return a.type_key < b.type_key; });
+
+    std::vector<const damb::TocEntry*> entries;
+    entries.reserve(static_cast<std::size_t>(last - first));
+    for (auto it = first; it != last; ++it) {
+        entries.push_back(&m_toc[it->toc_position]);
+    }
+
+    return entries;
+}
+
+std::vector<u32> DambFile::computeChecksums(const std::size_t worker_count) const {
+    std::vector<u32> checksums(m_toc.size(), 0);
+    std::atomic<std::size_t> next_chunk {0};
+
+    // chunks are handed out one at a time so a single large IMAG does not stall a whole stripe
+    const auto worker = [this, &checksums, &next_chunk]() {
+        for (std::size_t i = next_chunk++; i < m_toc.size(); i = next_chunk++) {
+            const amb::utility::ByteSpan chunk = chunkBytes(m_toc[i]);
+            checksums[i] = amb::utility::crc32(chunk.data(), chunk.size());
+        }
+    };
+
+    const std::size_t thread_count = std::min(std::max<std::size_t>(worker_count, 1), m_toc.size());
+    std::vector<std::thread> threads;
+    if (thread_count > 1) {
+        threads.reserve(thread_count - 1);
+        for (std::size_t i = 1; i < thread_count; i++) {
+            threads.emplace_back(worker);
+        }
+    }
+
+    worker();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    return checksums;
+}
+
+void DambFile::verifyChecksums(const std::size_t worker_count) const {
+    if (!hasChunkChecksums()) {
+        return;
+    }
+
+    const std::vector<u32> checksums = computeChecksums(worker_count);
+    for (std::size_t i = 0; i < m_toc.size(); i++) {
+        if (checksums[i] != m_toc[i].crc32) {
+            throw std::runtime_error(
+                "CRC mismatch in " + std::string(m_toc[i].type, amb::data::CHUNK_TYPE_LENGTH) +
+                " chunk id=" + std::to_string(m_toc[i].id) + ".");
+        }
+    }
+
+    for (std::atomic<bool>& verified : m_chunk_verified) {
+        verified.store(true, std::memory_order_relaxed);
+    }
+}
+
+void DambFile::verifyChunk(const damb::TocEntry& entry) const {
+    if (!hasChunkChecksums()) {
+        return;
+    }
+
+    const std::size_t index = static_cast<std::size_t>(&entry - m_toc.data());
+    if (index >= m_toc.size()) {
+        throw std::runtime_error("TOC entry does not belong to this file.");
+    }
+
+    if (m_chunk_verified[index].load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    const amb::utility::ByteSpan chunk = chunkBytes(entry);
+    if (amb::utility::crc32(chunk.data(), chunk.size()) != entry.crc32) {
+        throw std::runtime_error(
+            "CRC mismatch in " + std::string(entry.type, amb::data::CHUNK_TYPE_LENGTH) +
+            " chunk id=" + std::to_string(entry.id) + ".");
+    }
+
+    m_chunk_verified[index].store(true, std::memory_order_relaxed);
+}
@@ -0,0 +1,75 @@
+#ifndef DAMB_FILE_HXX_INCLUDED
+#define DAMB_FILE_HXX_INCLUDED
+
+#include "damb_format.hxx"
+#include "utility_binary.hxx"
+
+#include <atomic>
+#include <cstddef>
+#include <filesystem>
+#include <vector>
+
+// read-only memory mapping of a .damb file; header and TOC are validated once on open,
+// chunk payloads are handed out as views straight into the mapping
+class DambFile {
+public:
+    explicit DambFile(const std::filesystem::path& file_path);
+    ~DambFile();
+
+    DambFile(const DambFile&) = delete;
+    DambFile& operator=(const DambFile&) = delete;
+
+    DambFile(DambFile&& other) noexcept;
+    DambFile& operator=(DambFile&& other) noexcept;
+
+    const std::filesystem::path& path() const noexcept { return m_path; }
+
+    amb::utility::ByteSpan bytes() const noexcept { return amb::utility::ByteSpan(m_data, m_size); }
+
+    const amb::damb::Header& header() const noexcept { return m_header; }
+
+    const amb::utility::PodSpan<amb::damb::TocEntry>& toc() const noexcept { return m_toc; }
+
+    amb::utility::ByteSpan chunkBytes(const amb::damb::TocEntry& entry) const;
+
+    // O(log n) lookup through the (type, id) index; nullptr when absent
+    const amb::damb::TocEntry* findChunk(const char* type, u16 id) const noexcept;
+
+    // every chunk of the given type, ordered by id
+    std::vector<const amb::damb::TocEntry*> chunksOfType(const char* type) const;
+
+    bool hasChunkChecksums() const noexcept { return (m_header.flags & amb::damb::HEADER_FLAG_CHUNK_CRC32) != 0; }
+
+    // CRC-32 of every chunk's stored bytes, in TOC order, computed across `worker_count` threads
+    std::vector<u32> computeChecksums(std::size_t worker_count) const;
+
+    // throws on the first mismatch; a no-op for files written without checksums
+    void verifyChecksums(std::size_t worker_count) const;
+
+    // checks one chunk the first time it is requested and remembers the result; safe to call from several threads
+    void verifyChunk(const amb::damb::TocEntry& entry) const;
+
+private:
+    struct TocIndexEntry {
+        u32 type_key = 0;
+        u16 id = 0;
+        u32 toc_position = 0;
+    };
+
+    void map();
+    void unmap() noexcept;
+    void validateHeader() const;
+    void validateToc();
+    void buildTocIndex();
+
+    std::filesystem::path m_path;
+    const u8* m_data = nullptr;
+    std::size_t m_size = 0;
+
+    amb::damb::Header m_header {};
+    amb::utility::PodSpan<amb::damb::TocEntry> m_toc {};
+    std::vector<TocIndexEntry> m_toc_index;
+    mutable std::vector<std::atomic<bool>> m_chunk_verified;
+};
+
+#endif
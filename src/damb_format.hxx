@@ -15,10 +15,24 @@ namespace amb::damb {
     constexpr const char* CL_IMAGE = "IMAG";
     constexpr const char* CL_ATLAS = "ATLS";
     constexpr const char* CL_MAP_LAYER = "MAPL";
+    constexpr const char* CL_ANIMATION = "ANIM";
+    constexpr const char* CL_MASK = "MASK";
     constexpr const char* CL_AUDIO = "AUDI";
     constexpr const char* CL_STRINGS = "STRS";
     constexpr const char* CL_ENTITY = "ENTS";
 
+    // low bits of TocEntry::flags select how the stored chunk bytes are compressed;
+    // `uncompressed_size` is the chunk size after decompression
+    enum class ChunkCompression : u32 {
+        none = 0,
+        lz4 = 1
+    };
+
+    constexpr u32 TOC_FLAG_COMPRESSION_MASK = 0x0000000Fu;
+
+    // Header::flags: every TocEntry::crc32 holds the CRC-32 of the chunk bytes as stored on disk
+    constexpr u32 HEADER_FLAG_CHUNK_CRC32 = 1u << 0;
+
     struct Header {
         char magic[8] = {};
         u64 file_size = 0;
@@ -54,6 +68,8 @@ namespace amb::damb {
     static_assert(sizeof(ChunkHeader) == CHUNK_HEADER_SIZE, "ChunkHeader size does not match stated value.");
     static_assert(std::is_trivially_copyable_v<ChunkHeader>, "ChunkHeader must be POD/trivially copyable.");
 
+    constexpr ChunkCompression TocCompression(u32 flags) { return static_cast<ChunkCompression>(flags & TOC_FLAG_COMPRESSION_MASK); }
+
     constexpr u64 Align8(u64 sz) { return (sz + 7u) & ~u64{7}; }
     constexpr u64 PadTo8(u64 sz) { return Align8(sz) - sz; }
 
@@ -7,10 +7,13 @@
 
 namespace amb::damb {
     enum class ImageFormat : u8 {
-        png = 1
+        png = 1,
+        // 8-bit R, G, B, A bytes per pixel (SDL_PIXELFORMAT_ABGR8888), rows `pitch` bytes apart; uploaded without decoding
+        rgba = 2,
     };
 
     constexpr u16 IMAG_HEADER_SIZE = 32;
+    constexpr u32 IMAG_RGBA_BYTES_PER_PIXEL = 4;
 
     struct ImageChunkHeader {
         ChunkHeader header;
@@ -18,8 +21,8 @@ namespace amb::damb {
         u32 width = 0;
         u32 height = 0;
         ImageFormat format = ImageFormat::png;
-        u8 reserved[7] = {};
-
+        u8 reserved[3] = {};
+        u32 pitch = 0;  // bytes per row for raw formats, 0 for png
     };
     static_assert(sizeof(ImageChunkHeader) == IMAG_HEADER_SIZE, "ImageChunkHeader size does not match stated value.");
     static_assert(std::is_trivially_copyable_v<ImageChunkHeader>, "ImageChunkHeader must be POD/trivially copyable.");
@@ -1,27 +1,25 @@
 #include "damb_loader.hxx"
 
 #include "utility_binary.hxx"
+#include "utility_lz.hxx"
+#include "utility_profile.hxx"
 
-#include <cstring>
 #include <limits>
+#include <memory>
 #include <stdexcept>
 #include <string>
+#include <system_error>
 
 namespace {
     namespace damb = amb::damb;
-}
 
-void DambLoader::validateFileHeader(const damb::Header& header) const {
-    if (std::memcmp(header.magic, damb::MAGIC, amb::data::MAGIC_LENGTH) != 0) {
-        throw std::runtime_error("Invalid DAMB magic value.");
-    }
+    constexpr std::size_t CHECKSUM_WORKER_COUNT = 4;
 
-    if (header.version != damb::VERSION) {
-        throw std::runtime_error("Unsupported DAMB version.");
-    }
-
-    if (header.toc_entry_size != damb::TOC_ENTRY_SIZE) {
-        throw std::runtime_error("Unexpected TOC entry size.");
+    // the same file reached through different relative paths should share cache entries
+    std::string resourceFileKey(const std::filesystem::path& path) {
+        std::error_code error;
+        const std::filesystem::path canonical = std::filesystem::weakly_canonical(path, error);
+        return (error ? path.lexically_normal() : canonical).string();
     }
 }
 
@@ -38,117 +36,200 @@ std::size_t DambLoader::checkedCellCount(u32 width, u32 height) const {
     return static_cast<std::size_t>(count);
 }
 
-u64 DambLoader::checkedMapPayloadSize(const std::size_t cell_count) const {
-    const u64 payload_size = static_cast<u64>(cell_count) * static_cast<u64>(damb::MAPCELL_SIZE);
-    if (payload_size > static_cast<u64>(std::numeric_limits<std::streamsize>::max())) {
-        throw std::runtime_error("MAPL payload is too large for stream I/O on this platform.");
+amb::utility::ByteSpan DambLoader::chunkData(
+    const DambFile& file,
+    const damb::TocEntry& entry,
+    amb::utility::ScratchArena& scratch) const
+{
+    AMB_PROFILE_SCOPE("damb chunk data");
+    if (m_checksum_policy == ChecksumPolicy::lazy) {
+        file.verifyChunk(entry);
     }
 
-    return payload_size;
-}
+    const amb::utility::ByteSpan stored = file.chunkBytes(entry);
 
-damb::TocEntry DambLoader::findMapLayerEntry(std::ifstream& stream, const damb::Header& header) const {
-    stream.seekg(static_cast<std::streamoff>(header.toc_offset), std::ios::beg);
-    if (!stream) {
-        throw std::runtime_error("Failed to seek to TOC.");
-    }
+    switch (damb::TocCompression(entry.flags)) {
+        case damb::ChunkCompression::none:
+            if (entry.uncompressed_size != entry.size) {
+                throw std::runtime_error("Uncompressed chunk has uncompressed_size different from its size.");
+            }
+            return stored;
+
+        case damb::ChunkCompression::lz4: {
+            if (entry.uncompressed_size > static_cast<u64>(std::numeric_limits<std::size_t>::max())) {
+                throw std::runtime_error("Compressed chunk is too large for this platform.");
+            }
 
-    for (u32 i = 0; i < header.toc_count; i++) {
-        const damb::TocEntry entry = amb::utility::readPod<damb::TocEntry>(stream, "TOC entry");
-        if (amb::utility::chunkTypeEquals(entry.type, damb::CL_MAP_LAYER)) {
-            return entry;
+            const std::size_t size = static_cast<std::size_t>(entry.uncompressed_size);
+            u8* inflated = scratch.allocate(size);
+            amb::utility::lzDecompress(stored, inflated, size);
+            return amb::utility::ByteSpan(inflated, size);
         }
     }
 
-    throw std::runtime_error("No MAPL chunk found in file.");
+    throw std::runtime_error(
+        "Unsupported compression for " + std::string(entry.type, amb::data::CHUNK_TYPE_LENGTH) +
+        " chunk id=" + std::to_string(entry.id) + ".");
 }
 
-damb::TocEntry DambLoader::findAtlasEntryByIdBeforeMapLayer(
-    std::ifstream& stream,
-    const damb::Header& header,
+const damb::TocEntry& DambLoader::findAtlasEntryByIdBeforeMapLayer(
+    const DambFile& file,
     const u16 atlas_id,
     const u64 mapl_offset) const
 {
-    stream.seekg(static_cast<std::streamoff>(header.toc_offset), std::ios::beg);
-    if (!stream) {
-        throw std::runtime_error("Failed to seek to TOC.");
-    }
-
-    for (u32 i = 0; i < header.toc_count; i++) {
-        const damb::TocEntry entry = amb::utility::readPod<damb::TocEntry>(stream, "TOC entry");
-        if (entry.offset >= mapl_offset) {
-            continue;
-        }
-
-        if (!amb::utility::chunkTypeEquals(entry.type, damb::CL_ATLAS) || entry.id != atlas_id) {
-            continue;
-        }
-
-        return entry;
+    const damb::TocEntry* entry = file.findChunk(damb::CL_ATLAS, atlas_id);
+    if (entry == nullptr || entry->offset >= mapl_offset) {
+        throw std::runtime_error(
+            "Missing atlas dependency for MAPL chunk. Expected atlas_id=" +
+            std::to_string(atlas_id) + " to reference an ATLS chunk appearing before MAPL.");
     }
 
-    throw std::runtime_error(
-        "Missing atlas dependency for MAPL chunk. Expected atlas_id=" +
-        std::to_string(atlas_id) + " to reference an ATLS chunk appearing before MAPL.");
+    return *entry;
 }
 
-damb::TocEntry DambLoader::findImageEntryByIdBeforeMapLayer(
-    std::ifstream& stream,
-    const damb::Header& header,
+const damb::TocEntry& DambLoader::findImageEntryByIdBeforeMapLayer(
+    const DambFile& file,
     const u16 image_id,
     const u64 mapl_offset) const
 {
-    stream.seekg(static_cast<std::streamoff>(header.toc_offset), std::ios::beg);
-    if (!stream) {
-        throw std::runtime_error("Failed to seek to TOC.");
+    const damb::TocEntry* entry = file.findChunk(damb::CL_IMAGE, image_id);
+    if (entry == nullptr || entry->offset >= mapl_offset) {
+        throw std::runtime_error(
+            "Missing image dependency for MAPL chunk. Expected image_id=" +
+            std::to_string(image_id) + " to reference an IMAG chunk appearing before MAPL.");
     }
 
-    for (u32 i = 0; i < header.toc_count; i++) {
-        const damb::TocEntry entry = amb::utility::readPod<damb::TocEntry>(stream, "TOC entry");
-        if (entry.offset >= mapl_offset) {
-            continue;
-        }
-
-        if (!amb::utility::chunkTypeEquals(entry.type, damb::CL_IMAGE) || entry.id != image_id) {
-            continue;
-        }
+    return *entry;
+}
 
-        return entry;
+DambFile DambLoader::openFile(const std::filesystem::path& file_path) const {
+    AMB_PROFILE_SCOPE("damb open");
+    DambFile file(file_path);
+    if (m_checksum_policy == ChecksumPolicy::eager) {
+        file.verifyChecksums(CHECKSUM_WORKER_COUNT);
     }
 
-    throw std::runtime_error(
-        "Missing image dependency for MAPL chunk. Expected image_id=" +
-        std::to_string(image_id) + " to reference an IMAG chunk appearing before MAPL.");
+    return file;
 }
 
-VisualLayerPtr DambLoader::loadMapLayer(SDL_Renderer* renderer, const std::filesystem::path& file_path) const {
-    std::ifstream stream(file_path, std::ios::binary);
-    if (!stream.is_open()) {
-        throw std::runtime_error("Unable to open file: " + file_path.string());
+std::vector<VisualLayerPtr> DambLoader::loadMapLayers(SDL_Renderer* renderer, const std::filesystem::path& file_path) const {
+    AMB_PROFILE_SCOPE("damb load layers");
+    const DambFile file = openFile(file_path);
+
+    const std::vector<const damb::TocEntry*> map_entries = file.chunksOfType(damb::CL_MAP_LAYER);
+    if (map_entries.empty()) {
+        throw std::runtime_error("No MAPL chunk found in file.");
+    }
+
+    std::vector<VisualLayerPtr> layers;
+    layers.reserve(map_entries.size());
+
+    amb::utility::ScratchArena scratch;
+    for (const damb::TocEntry* map_entry : map_entries) {
+        layers.push_back(finishMapLayer(renderer, prepareMapLayer(file, *map_entry, scratch)));
     }
 
-    const damb::Header header = amb::utility::readPod<damb::Header>(stream, "file header");
-    validateFileHeader(header);
+    return layers;
+}
 
-    const damb::TocEntry map_entry = findMapLayerEntry(stream, header);
-    const damb::MapLayerChunkHeader map_header = loadMapLayerHeader(stream, map_entry);
+DambLoader::PreparedMapLayer DambLoader::prepareMapLayer(
+    const DambFile& file,
+    const damb::TocEntry& map_entry,
+    amb::utility::ScratchArena& scratch) const
+{
+    AMB_PROFILE_SCOPE("damb prepare layer");
+    // every chunk of the previous layer has been consumed by now
+    scratch.reset();
+
+    const amb::utility::ByteSpan map_chunk = chunkData(file, map_entry, scratch);
+    const damb::MapLayerChunkHeader map_header = loadMapLayerHeader(map_chunk, map_entry);
+    const std::string file_key = resourceFileKey(file.path());
+
+    const damb::TocEntry& atlas_entry = findAtlasEntryByIdBeforeMapLayer(file, map_header.atlas_id, map_entry.offset);
+    const ResourceKey atlas_key {file_key, atlas_entry.id};
+    AtlasRuntimePtr atlas_runtime = (m_resource_cache != nullptr) ? m_resource_cache->findAtlas(atlas_key) : nullptr;
+    if (atlas_runtime == nullptr) {
+        AtlasRuntime loaded = loadAtlasRuntime(chunkData(file, atlas_entry, scratch), atlas_entry);
+        if (const damb::TocEntry* anim_entry = file.findChunk(damb::CL_ANIMATION, atlas_entry.id)) {
+            if (anim_entry->offset <= atlas_entry.offset) {
+                throw std::runtime_error(
+                    "Out of order ANIM chunk. Expected ANIM id=" + std::to_string(anim_entry->id) +
+                    " to appear after the ATLS chunk it extends.");
+            }
+            loadAtlasAnimations(chunkData(file, *anim_entry, scratch), *anim_entry, loaded);
+        }
+        if (const damb::TocEntry* mask_entry = file.findChunk(damb::CL_MASK, atlas_entry.id)) {
+            if (mask_entry->offset <= atlas_entry.offset) {
+                throw std::runtime_error(
+                    "Out of order MASK chunk. Expected MASK id=" + std::to_string(mask_entry->id) +
+                    " to appear after the ATLS chunk it extends.");
+            }
+            loadAtlasMasks(chunkData(file, *mask_entry, scratch), *mask_entry, loaded);
+        }
 
-    const damb::TocEntry atlas_entry = findAtlasEntryByIdBeforeMapLayer(stream, header, map_header.atlas_id, map_entry.offset);
-    const AtlasChunkRuntimeData atlas_runtime_data = loadAtlasRuntime(stream, atlas_entry);
+        std::size_t atlas_bytes = loaded.rects.size() * sizeof(SDL_FRect) + loaded.opaque.size() + loaded.solid.size()
+            + loaded.masks.byteSize();
+        for (const TileAnimation& animation : loaded.animations) {
+            atlas_bytes += sizeof(TileAnimation) + animation.frames.size() * sizeof(TileAnimationFrame);
+        }
+        atlas_runtime = (m_resource_cache != nullptr)
+            ? m_resource_cache->insertAtlas(atlas_key, std::move(loaded), atlas_bytes)
+            : std::make_shared<const AtlasRuntime>(std::move(loaded));
+    }
 
-    const damb::TocEntry image_entry = findImageEntryByIdBeforeMapLayer(
-        stream,
-        header,
-        atlas_runtime_data.metadata.image_id,
-        map_entry.offset);
-    ImageRuntime image_runtime = loadImageRuntime(stream, image_entry, renderer);
+    const AtlasChunkMetadata atlas_metadata {
+        static_cast<u32>(atlas_runtime->rects.size()),
+        atlas_runtime->image_id,
+    };
+
+    const damb::TocEntry& image_entry = findImageEntryByIdBeforeMapLayer(file, atlas_metadata.image_id, map_entry.offset);
+    ResourceKey image_key {file_key, image_entry.id};
+    ImageRuntimePtr image_runtime = (m_resource_cache != nullptr) ? m_resource_cache->findImage(image_key) : nullptr;
+    SurfacePtr image_surface;
+    if (image_runtime == nullptr) {
+        image_surface = decodeImageSurface(chunkData(file, image_entry, scratch), image_entry);
+    }
 
-    MapRuntime map_runtime = loadMapRuntime(stream, map_entry, map_header, atlas_runtime_data.metadata);
+    MapRuntime map_runtime = loadMapRuntime(map_chunk, map_header, atlas_metadata);
     const amb::runtime::SpawnPoint spawn_point = map_runtime.defaultSpawnPoint();
+    CollisionMap collision = CollisionMap::build(map_runtime, atlas_runtime->solid);
 
-    return std::make_unique<MapLayer>(
+    return PreparedMapLayer {
+        std::move(image_key),
         std::move(image_runtime),
-        std::move(atlas_runtime_data.atlas_runtime),
+        std::move(image_surface),
+        std::move(atlas_runtime),
         std::move(map_runtime),
-        spawn_point);
+        spawn_point,
+        std::move(collision),
+        map_header.z,
+    };
+}
+
+VisualLayerPtr DambLoader::finishMapLayer(SDL_Renderer* renderer, PreparedMapLayer prepared) const {
+    AMB_PROFILE_SCOPE("damb finish layer");
+    ImageRuntimePtr image_runtime = std::move(prepared.image_runtime);
+
+    // an earlier layer of the same pack may have uploaded this image since it was decoded
+    if (image_runtime == nullptr && m_resource_cache != nullptr) {
+        image_runtime = m_resource_cache->findImage(prepared.image_key);
+    }
+
+    if (image_runtime == nullptr) {
+        SDL_Surface* surface = prepared.image_surface.get();
+        ImageRuntime uploaded = uploadImageRuntime(surface, renderer);
+        const std::size_t texture_bytes = static_cast<std::size_t>(surface->w) * static_cast<std::size_t>(surface->h) * 4;
+        image_runtime = (m_resource_cache != nullptr)
+            ? m_resource_cache->insertImage(prepared.image_key, std::move(uploaded), texture_bytes)
+            : std::make_shared<const ImageRuntime>(std::move(uploaded));
+    }
+
+    auto layer = std::make_unique<MapLayer>(
+        std::move(image_runtime),
+        std::move(prepared.atlas_runtime),
+        std::move(prepared.map_runtime),
+        prepared.spawn_point);
+    layer->setZ(prepared.z);
+    layer->setCollision(std::move(prepared.collision));
+    return layer;
 }
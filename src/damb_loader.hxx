@@ -1,55 +1,119 @@
 #ifndef DAMB_LOADER_HXX_INCLUDED
 #define DAMB_LOADER_HXX_INCLUDED
 
+#include "damb_file.hxx"
 #include "damb_mapl.hxx"
 #include "damb_format.hxx"
+#include "damb_imag.hxx"
+#include "entity_store.hxx"
+#include "resource_cache.hxx"
+#include "utility_arena.hxx"
 #include "visual_layers.hxx"
 
 #include <filesystem>
-#include <fstream>
+#include <vector>
 
 class DambLoader {
 public:
+    // when chunk CRCs are checked: all chunks up front (in parallel), each chunk the first time it is read, or not at all
+    enum class ChecksumPolicy : u8 {
+        eager,
+        lazy,
+        never,
+    };
+
     DambLoader() = default;
+    explicit DambLoader(ChecksumPolicy checksum_policy)
+    : m_checksum_policy(checksum_policy) {}
+
+    // everything a MapLayer needs except GPU resources; produced off the render thread
+    struct PreparedMapLayer {
+        ResourceKey image_key;
+        ImageRuntimePtr image_runtime;  // already resident in the resource cache
+        SurfacePtr image_surface;       // decoded image waiting for upload otherwise
+        AtlasRuntimePtr atlas_runtime;
+        MapRuntime map_runtime;
+        amb::runtime::SpawnPoint spawn_point;
+        CollisionMap collision;
+        i32 z = 0;
+    };
 
-    VisualLayerPtr loadMapLayer(SDL_Renderer* renderer, const std::filesystem::path& file_path) const;
+    ChecksumPolicy checksumPolicy() const noexcept { return m_checksum_policy; }
+    void setChecksumPolicy(ChecksumPolicy checksum_policy) noexcept { m_checksum_policy = checksum_policy; }
 
-private:
+    // storage order of every MapRuntime the loader builds; decoding always produces rows, bricked maps are
+    // reordered once afterwards
+    amb::runtime::CellLayout cellLayout() const noexcept { return m_cell_layout; }
+    void setCellLayout(amb::runtime::CellLayout cell_layout) noexcept { m_cell_layout = cell_layout; }
+
+    // shares images and atlases between layers and files; the cache must outlive the loader and its copies
+    ResourceCache* resourceCache() const noexcept { return m_resource_cache; }
+    void setResourceCache(ResourceCache* resource_cache) noexcept { m_resource_cache = resource_cache; }
+
+    // one layer per MAPL chunk in the file, ordered by MAPL id
+    std::vector<VisualLayerPtr> loadMapLayers(SDL_Renderer* renderer, const std::filesystem::path& file_path) const;
+
+    // maps the file and applies the eager checksum policy
+    DambFile openFile(const std::filesystem::path& file_path) const;
+
+    // CPU half of loading one MAPL layer (chunk parsing and image decode); safe to run on worker threads
+    PreparedMapLayer prepareMapLayer(
+        const DambFile& file,
+        const amb::damb::TocEntry& map_entry,
+        amb::utility::ScratchArena& scratch) const;
+
+    // GPU half: uploads the decoded image; must run on the thread that owns the renderer
+    VisualLayerPtr finishMapLayer(SDL_Renderer* renderer, PreparedMapLayer prepared) const;
+
+    // every ENTS chunk's entities, clamped to the largest map they reference; empty when the file has none.
+    // CPU only, safe to run on worker threads
+    amb::entity::EntityStore loadEntityStore(const DambFile& file, amb::utility::ScratchArena& scratch) const;
+
+    // individual chunk steps behind prepareMapLayer / finishMapLayer, public so tools and benchmarks can time them
     struct AtlasChunkMetadata {
         u32 asset_count = 0;
         u16 image_id = 0;
     };
 
-    struct AtlasChunkRuntimeData {
-        AtlasRuntime atlas_runtime {};
-        AtlasChunkMetadata metadata {};
-    };
+    // chunk bytes as the chunk parsers expect them; compressed chunks are inflated into `scratch`
+    amb::utility::ByteSpan chunkData(const DambFile& file, const amb::damb::TocEntry& entry, amb::utility::ScratchArena& scratch) const;
 
-    void validateFileHeader(const amb::damb::Header& header) const;
+    amb::damb::MapLayerChunkHeader loadMapLayerHeader(const amb::utility::ByteSpan& map_chunk, const amb::damb::TocEntry& map_entry) const;
+    AtlasRuntime loadAtlasRuntime(const amb::utility::ByteSpan& atlas_chunk, const amb::damb::TocEntry& atlas_entry) const;
+    // attaches the ANIM chunk's sequences to an already loaded atlas
+    void loadAtlasAnimations(const amb::utility::ByteSpan& anim_chunk, const amb::damb::TocEntry& anim_entry, AtlasRuntime& atlas) const;
+    // attaches the MASK chunk's per-record pixel masks to an already loaded atlas
+    void loadAtlasMasks(const amb::utility::ByteSpan& mask_chunk, const amb::damb::TocEntry& mask_entry, AtlasRuntime& atlas) const;
+    // appends one ENTS chunk's entities; `map_header` is the MAPL chunk it references
+    void loadEntities(
+        const amb::utility::ByteSpan& ents_chunk,
+        const amb::damb::TocEntry& ents_entry,
+        const amb::damb::MapLayerChunkHeader& map_header,
+        amb::entity::EntityStore& store) const;
+    SurfacePtr decodeImageSurface(const amb::utility::ByteSpan& image_chunk, const amb::damb::TocEntry& image_entry) const;
+    ImageRuntime uploadImageRuntime(SDL_Surface* surface, SDL_Renderer* renderer) const;
+    MapRuntime loadMapRuntime(
+        const amb::utility::ByteSpan& map_chunk,
+        const amb::damb::MapLayerChunkHeader& map_header,
+        const AtlasChunkMetadata& atlas_metadata) const;
 
-    amb::damb::TocEntry findMapLayerEntry(std::ifstream& stream, const amb::damb::Header& header) const;
-    amb::damb::TocEntry findAtlasEntryByIdBeforeMapLayer(
-        std::ifstream& stream,
-        const amb::damb::Header& header,
+private:
+    const amb::damb::TocEntry& findAtlasEntryByIdBeforeMapLayer(
+        const DambFile& file,
         u16 atlas_id,
         u64 mapl_offset) const;
-    amb::damb::TocEntry findImageEntryByIdBeforeMapLayer(
-        std::ifstream& stream,
-        const amb::damb::Header& header,
+    const amb::damb::TocEntry& findImageEntryByIdBeforeMapLayer(
+        const DambFile& file,
         u16 image_id,
         u64 mapl_offset) const;
 
-    amb::damb::MapLayerChunkHeader loadMapLayerHeader(std::ifstream& stream, const amb::damb::TocEntry& map_entry) const;
-    AtlasChunkRuntimeData loadAtlasRuntime(std::ifstream& stream, const amb::damb::TocEntry& atlas_entry) const;
-    ImageRuntime loadImageRuntime(std::ifstream& stream, const amb::damb::TocEntry& image_entry, SDL_Renderer* renderer) const;
-    MapRuntime loadMapRuntime(
-        std::ifstream& stream,
-        const amb::damb::TocEntry& map_entry,
-        const amb::damb::MapLayerChunkHeader& map_header,
-        const AtlasChunkMetadata& atlas_metadata) const;
+    SurfacePtr copyRgbaSurface(const amb::utility::ByteSpan& pixels, const amb::damb::ImageChunkHeader& image_header) const;
 
     std::size_t checkedCellCount(u32 width, u32 height) const;
-    u64 checkedMapPayloadSize(std::size_t cell_count) const;
+
+    ChecksumPolicy m_checksum_policy = ChecksumPolicy::lazy;
+    amb::runtime::CellLayout m_cell_layout = amb::runtime::CellLayout::row_major;
+    ResourceCache* m_resource_cache = nullptr;
 };
 
 #endif
@@ -1,23 +1,24 @@
 #include "damb_loader.hxx"
+#include "damb_anim.hxx"
 #include "damb_atls.hxx"
+#include "damb_mask.hxx"
 
 #include "utility_binary.hxx"
+#include "utility_profile.hxx"
 
 #include <limits>
 #include <stdexcept>
+#include <string>
+#include <utility>
 #include <vector>
 
 namespace {
     namespace damb = amb::damb;
 }
 
-DambLoader::AtlasChunkRuntimeData DambLoader::loadAtlasRuntime(std::ifstream& stream, const damb::TocEntry& atlas_entry) const {
-    stream.seekg(static_cast<std::streamoff>(atlas_entry.offset), std::ios::beg);
-    if (!stream) {
-        throw std::runtime_error("Failed to seek to ATLS chunk.");
-    }
-
-    const damb::AtlasChunkHeader atlas_header = amb::utility::readPod<damb::AtlasChunkHeader>(stream, "ATLS header");
+AtlasRuntime DambLoader::loadAtlasRuntime(const amb::utility::ByteSpan& atlas_chunk, const damb::TocEntry& atlas_entry) const {
+    AMB_PROFILE_SCOPE("damb atlas");
+    const damb::AtlasChunkHeader atlas_header = amb::utility::readPod<damb::AtlasChunkHeader>(atlas_chunk, 0, "ATLS header");
     if (!amb::utility::chunkTypeEquals(atlas_header.header.type, damb::CL_ATLAS)) {
         throw std::runtime_error("TOC ATLS entry points to a non-ATLS chunk.");
     }
@@ -26,11 +27,11 @@ DambLoader::AtlasChunkRuntimeData DambLoader::loadAtlasRuntime(std::ifstream& st
         throw std::runtime_error("TOC ATLS entry id does not match ATLS chunk header id.");
     }
 
-    if (atlas_entry.size < damb::ATLS_HEADER_SIZE) {
-        throw std::runtime_error("ATLS TOC size is smaller than ATLS header size.");
+    if (atlas_chunk.size() < damb::ATLS_HEADER_SIZE) {
+        throw std::runtime_error("ATLS chunk size is smaller than ATLS header size.");
     }
 
-    const u64 record_bytes = atlas_entry.size - static_cast<u64>(damb::ATLS_HEADER_SIZE);
+    const u64 record_bytes = static_cast<u64>(atlas_chunk.size()) - static_cast<u64>(damb::ATLS_HEADER_SIZE);
     if ((record_bytes % static_cast<u64>(damb::ATLS_RECORD_SIZE)) != 0) {
         throw std::runtime_error("ATLS payload size is not aligned to AtlasRecord size.");
     }
@@ -44,16 +45,17 @@ DambLoader::AtlasChunkRuntimeData DambLoader::loadAtlasRuntime(std::ifstream& st
         throw std::runtime_error("ATLS has too many records for this platform.");
     }
 
-    std::vector<damb::AtlasRecord> records(static_cast<std::size_t>(toc_record_count));
-    if (!records.empty()) {
-        stream.read(reinterpret_cast<char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(damb::AtlasRecord)));
-        if (!stream) {
-            throw std::runtime_error("Failed to read ATLS records.");
-        }
-    }
+    const amb::utility::PodSpan<damb::AtlasRecord> records = amb::utility::viewPodArray<damb::AtlasRecord>(
+        atlas_chunk,
+        damb::ATLS_HEADER_SIZE,
+        toc_record_count,
+        "ATLS records");
 
     AtlasRuntime atlas_runtime {};
+    atlas_runtime.image_id = atlas_header.image_id;
     atlas_runtime.rects.reserve(records.size());
+    atlas_runtime.opaque.reserve(records.size());
+    atlas_runtime.solid.reserve(records.size());
 
     for (const damb::AtlasRecord& record : records) {
         atlas_runtime.rects.push_back(SDL_FRect {
@@ -62,13 +64,163 @@ DambLoader::AtlasChunkRuntimeData DambLoader::loadAtlasRuntime(std::ifstream& st
             static_cast<float>(record.src_w),
             static_cast<float>(record.src_h),
         });
+        atlas_runtime.opaque.push_back((record.flags & damb::ATLS_RECORD_FLAG_OPAQUE) != 0 ? 1 : 0);
+        atlas_runtime.solid.push_back((record.flags & damb::ATLS_RECORD_FLAG_SOLID) != 0 ? 1 : 0);
+    }
+
+    return atlas_runtime;
+}
+
+void DambLoader::loadAtlasAnimations(
+    const amb::utility::ByteSpan& anim_chunk,
+    const damb::TocEntry& anim_entry,
+    AtlasRuntime& atlas) const
+{
+    AMB_PROFILE_SCOPE("damb animations");
+    const damb::AnimationChunkHeader anim_header = amb::utility::readPod<damb::AnimationChunkHeader>(anim_chunk, 0, "ANIM header");
+    if (!amb::utility::chunkTypeEquals(anim_header.header.type, damb::CL_ANIMATION)) {
+        throw std::runtime_error("TOC ANIM entry points to a non-ANIM chunk.");
+    }
+
+    if (anim_header.header.id != anim_entry.id) {
+        throw std::runtime_error("TOC ANIM entry id does not match ANIM chunk header id.");
+    }
+
+    const u64 expected_size = static_cast<u64>(damb::ANIM_HEADER_SIZE)
+        + static_cast<u64>(anim_header.sequence_count) * damb::ANIM_SEQUENCE_SIZE
+        + static_cast<u64>(anim_header.frame_count) * damb::ANIM_FRAME_SIZE;
+    if (expected_size != static_cast<u64>(anim_chunk.size())) {
+        throw std::runtime_error("ANIM chunk size does not match its sequence and frame counts.");
     }
 
-    return AtlasChunkRuntimeData {
-        std::move(atlas_runtime),
-        AtlasChunkMetadata {
-            atlas_header.asset_count,
-            atlas_header.image_id,
+    const amb::utility::PodSpan<damb::AnimationSequence> sequences = amb::utility::viewPodArray<damb::AnimationSequence>(
+        anim_chunk,
+        damb::ANIM_HEADER_SIZE,
+        anim_header.sequence_count,
+        "ANIM sequences");
+    const amb::utility::PodSpan<damb::AnimationFrame> frames = amb::utility::viewPodArray<damb::AnimationFrame>(
+        anim_chunk,
+        damb::ANIM_HEADER_SIZE + static_cast<std::size_t>(anim_header.sequence_count) * damb::ANIM_SEQUENCE_SIZE,
+        anim_header.frame_count,
+        "ANIM frames");
+
+    const std::size_t rect_count = atlas.rects.size();
+    std::vector<u8> animated(rect_count, 0);
+    atlas.animations.clear();
+    atlas.animations.reserve(sequences.size());
+
+    for (const damb::AnimationSequence& sequence : sequences) {
+        if (sequence.atlas_record_index >= rect_count) {
+            throw std::runtime_error("ANIM sequence references atlas record " + std::to_string(sequence.atlas_record_index) + " out of range.");
+        }
+
+        if (animated[sequence.atlas_record_index] != 0) {
+            throw std::runtime_error("ANIM defines atlas record " + std::to_string(sequence.atlas_record_index) + " more than once.");
+        }
+
+        if (sequence.frame_count == 0 ||
+            static_cast<u64>(sequence.first_frame) + sequence.frame_count > static_cast<u64>(frames.size())) {
+            throw std::runtime_error("ANIM sequence frame range is empty or out of range.");
+        }
+
+        TileAnimation animation {};
+        animation.atlas_index = sequence.atlas_record_index;
+        animation.frames.reserve(sequence.frame_count);
+
+        // the base cell only counts as opaque when every frame it can show is
+        bool opaque = true;
+        u64 cycle_ms = 0;
+        for (u32 i = 0; i < sequence.frame_count; i++) {
+            const damb::AnimationFrame& frame = frames[sequence.first_frame + i];
+            if (frame.atlas_record_index >= rect_count || frame.duration_ms == 0) {
+                throw std::runtime_error("ANIM frame references an out of range atlas record or has zero duration.");
+            }
+
+            cycle_ms += frame.duration_ms;
+            opaque = opaque && atlas.opaque[frame.atlas_record_index] != 0;
+            animation.frames.push_back(TileAnimationFrame {frame.atlas_record_index, frame.duration_ms});
+        }
+
+        if (cycle_ms > std::numeric_limits<u32>::max()) {
+            throw std::runtime_error("ANIM sequence is longer than the supported cycle length.");
         }
-    };
+
+        animation.cycle_ms = static_cast<u32>(cycle_ms);
+        animated[sequence.atlas_record_index] = 1;
+        atlas.opaque[sequence.atlas_record_index] = opaque ? 1 : 0;
+        atlas.animations.push_back(std::move(animation));
+    }
+}
+
+void DambLoader::loadAtlasMasks(
+    const amb::utility::ByteSpan& mask_chunk,
+    const damb::TocEntry& mask_entry,
+    AtlasRuntime& atlas) const
+{
+    AMB_PROFILE_SCOPE("damb masks");
+    const damb::MaskChunkHeader mask_header = amb::utility::readPod<damb::MaskChunkHeader>(mask_chunk, 0, "MASK header");
+    if (!amb::utility::chunkTypeEquals(mask_header.header.type, damb::CL_MASK)) {
+        throw std::runtime_error("TOC MASK entry points to a non-MASK chunk.");
+    }
+
+    if (mask_header.header.id != mask_entry.id) {
+        throw std::runtime_error("TOC MASK entry id does not match MASK chunk header id.");
+    }
+
+    if (mask_header.alpha_threshold == 0) {
+        throw std::runtime_error("MASK chunk has a zero alpha threshold.");
+    }
+
+    if (mask_header.record_count != atlas.rects.size()) {
+        throw std::runtime_error("MASK record count does not match the atlas record count.");
+    }
+
+    const u64 expected_size = static_cast<u64>(damb::MASK_HEADER_SIZE)
+        + static_cast<u64>(mask_header.record_count) * damb::MASK_RECORD_SIZE
+        + static_cast<u64>(mask_header.word_count) * sizeof(u64);
+    if (expected_size != static_cast<u64>(mask_chunk.size())) {
+        throw std::runtime_error("MASK chunk size does not match its record and word counts.");
+    }
+
+    const amb::utility::PodSpan<damb::MaskRecord> records = amb::utility::viewPodArray<damb::MaskRecord>(
+        mask_chunk,
+        damb::MASK_HEADER_SIZE,
+        mask_header.record_count,
+        "MASK records");
+    const amb::utility::PodSpan<u64> words = amb::utility::viewPodArray<u64>(
+        mask_chunk,
+        damb::MASK_HEADER_SIZE + static_cast<std::size_t>(mask_header.record_count) * damb::MASK_RECORD_SIZE,
+        mask_header.word_count,
+        "MASK words");
+
+    std::vector<PixelMaskSet::Entry> entries;
+    entries.reserve(records.size());
+    for (std::size_t i = 0; i < records.size(); i++) {
+        const damb::MaskRecord& record = records[i];
+        const SDL_FRect& rect = atlas.rects[i];
+        if (static_cast<float>(record.width) != rect.w || static_cast<float>(record.height) != rect.h) {
+            throw std::runtime_error("MASK record " + std::to_string(i) + " does not match the size of its atlas record.");
+        }
+
+        const u64 word_count = static_cast<u64>((record.width + 63u) / 64u) * record.height;
+        if (static_cast<u64>(record.first_word) + word_count > static_cast<u64>(words.size())) {
+            throw std::runtime_error("MASK record " + std::to_string(i) + " word range is out of range.");
+        }
+
+        // PixelMask::overlaps ANDs whole words, so bits past the width must be clear
+        const u32 tail_bits = record.width % 64;
+        if (tail_bits != 0) {
+            const u32 words_per_row = (record.width + 63u) / 64u;
+            const u64 padding = ~u64 {0} << tail_bits;
+            for (u32 row = 0; row < record.height; row++) {
+                if ((words[record.first_word + static_cast<std::size_t>(row) * words_per_row + words_per_row - 1] & padding) != 0) {
+                    throw std::runtime_error("MASK record " + std::to_string(i) + " sets bits past its width.");
+                }
+            }
+        }
+
+        entries.push_back(PixelMaskSet::Entry {record.width, record.height, record.first_word});
+    }
+
+    atlas.masks = PixelMaskSet(std::move(entries), std::vector<u64>(words.begin(), words.end()), mask_header.alpha_threshold);
 }
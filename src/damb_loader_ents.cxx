@@ -0,0 +1,130 @@
+#include "damb_loader.hxx"
+#include "damb_ents.hxx"
+
+#include "utility_binary.hxx"
+#include "utility_profile.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace {
+    namespace damb = amb::damb;
+
+    amb::entity::EntityType entityType(const damb::EntityType type) {
+        switch (type) {
+            case damb::EntityType::player:
+                return amb::entity::EntityType::player;
+            case damb::EntityType::npc:
+                return amb::entity::EntityType::npc;
+        }
+
+        throw std::runtime_error("ENTS record has an unknown entity type " + std::to_string(static_cast<u32>(type)) + ".");
+    }
+}
+
+amb::entity::EntityStore DambLoader::loadEntityStore(const DambFile& file, amb::utility::ScratchArena& scratch) const {
+    AMB_PROFILE_SCOPE("damb entities");
+    amb::entity::EntityStore store;
+
+    for (const damb::TocEntry* ents_entry : file.chunksOfType(damb::CL_ENTITY)) {
+        scratch.reset();
+        const amb::utility::ByteSpan ents_chunk = chunkData(file, *ents_entry, scratch);
+        const damb::EntityChunkHeader ents_header = amb::utility::readPod<damb::EntityChunkHeader>(ents_chunk, 0, "ENTS header");
+
+        const damb::TocEntry* map_entry = file.findChunk(damb::CL_MAP_LAYER, ents_header.map_id);
+        if (map_entry == nullptr || map_entry->offset >= ents_entry->offset) {
+            throw std::runtime_error(
+                "Missing map dependency for ENTS chunk. Expected map_id=" +
+                std::to_string(ents_header.map_id) + " to reference a MAPL chunk appearing before ENTS.");
+        }
+
+        // arena allocations stay valid until reset, so the ENTS bytes survive inflating the MAPL chunk
+        const damb::MapLayerChunkHeader map_header = loadMapLayerHeader(chunkData(file, *map_entry, scratch), *map_entry);
+        loadEntities(ents_chunk, *ents_entry, map_header, store);
+
+        store.setBounds(
+            std::max(store.boundsWidth(), static_cast<float>(map_header.width) * amb::game::MAP_TILE_SIZE),
+            std::max(store.boundsHeight(), static_cast<float>(map_header.height) * amb::game::MAP_TILE_SIZE));
+    }
+
+    return store;
+}
+
+void DambLoader::loadEntities(
+    const amb::utility::ByteSpan& ents_chunk,
+    const damb::TocEntry& ents_entry,
+    const damb::MapLayerChunkHeader& map_header,
+    amb::entity::EntityStore& store) const
+{
+    const damb::EntityChunkHeader ents_header = amb::utility::readPod<damb::EntityChunkHeader>(ents_chunk, 0, "ENTS header");
+    if (!amb::utility::chunkTypeEquals(ents_header.header.type, damb::CL_ENTITY)) {
+        throw std::runtime_error("TOC ENTS entry points to a non-ENTS chunk.");
+    }
+
+    if (ents_header.header.id != ents_entry.id) {
+        throw std::runtime_error("TOC ENTS entry id does not match ENTS chunk header id.");
+    }
+
+    if (ents_header.map_id != map_header.header.id) {
+        throw std::runtime_error("ENTS chunk is validated against a MAPL chunk it does not reference.");
+    }
+
+    const u64 expected_size = static_cast<u64>(damb::ENTS_HEADER_SIZE)
+        + static_cast<u64>(ents_header.entity_count) * damb::ENTS_RECORD_SIZE;
+    if (expected_size != static_cast<u64>(ents_chunk.size())) {
+        throw std::runtime_error("ENTS chunk size does not match its entity count.");
+    }
+
+    if (store.size() + ents_header.entity_count > amb::entity::MAX_ENTITIES) {
+        throw std::runtime_error("ENTS chunks define more than " + std::to_string(amb::entity::MAX_ENTITIES) + " entities.");
+    }
+
+    const amb::utility::PodSpan<damb::EntityRecord> records = amb::utility::viewPodArray<damb::EntityRecord>(
+        ents_chunk,
+        damb::ENTS_HEADER_SIZE,
+        ents_header.entity_count,
+        "ENTS records");
+
+    bool has_player = false;
+    for (std::size_t slot = 0; slot < store.size(); slot++) {
+        has_player = has_player || store.type(slot) == amb::entity::EntityType::player;
+    }
+
+    store.reserve(store.size() + records.size());
+    const float tile_size = static_cast<float>(amb::game::MAP_TILE_SIZE);
+
+    for (const damb::EntityRecord& record : records) {
+        if (record.tile_x >= map_header.width || record.tile_y >= map_header.height) {
+            throw std::runtime_error(
+                "ENTS entity " + std::to_string(record.id) + " spawns outside map " + std::to_string(map_header.header.id) + ".");
+        }
+
+        if (!std::isfinite(record.heading) || !std::isfinite(record.speed) || record.speed < 0.0f) {
+            throw std::runtime_error("ENTS entity " + std::to_string(record.id) + " has an invalid heading or speed.");
+        }
+
+        if ((record.flags & ~damb::ENTS_RECORD_FLAG_MASK) != 0) {
+            throw std::runtime_error("ENTS entity " + std::to_string(record.id) + " sets unknown flags.");
+        }
+
+        amb::entity::EntitySpawn spawn {};
+        spawn.id = record.id;
+        spawn.type = entityType(record.type);
+        spawn.flags = ((record.flags & damb::ENTS_RECORD_FLAG_FROZEN) != 0) ? amb::entity::ENTITY_FLAG_FROZEN : 0;
+        spawn.world_x = (static_cast<float>(record.tile_x) + 0.5f) * tile_size;
+        spawn.world_y = (static_cast<float>(record.tile_y) + 0.5f) * tile_size;
+        spawn.heading = record.heading;
+        spawn.speed = record.speed;
+
+        if (spawn.type == amb::entity::EntityType::player) {
+            if (has_player) {
+                throw std::runtime_error("ENTS defines more than one player spawn.");
+            }
+            has_player = true;
+        }
+
+        store.add(spawn);
+    }
+}
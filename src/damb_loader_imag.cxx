@@ -2,29 +2,22 @@
 #include "damb_imag.hxx"
 
 #include "utility_binary.hxx"
+#include "utility_profile.hxx"
 
 #include <SDL3_image/SDL_image.h>
 
+#include <cstring>
 #include <limits>
 #include <stdexcept>
 #include <string>
-#include <vector>
 
 namespace {
     namespace damb = amb::damb;
 }
 
-ImageRuntime DambLoader::loadImageRuntime(std::ifstream& stream, const damb::TocEntry& image_entry, SDL_Renderer* renderer) const {
-    if (renderer == nullptr) {
-        throw std::runtime_error("Cannot load IMAG chunk without a valid SDL_Renderer.");
-    }
-
-    stream.seekg(static_cast<std::streamoff>(image_entry.offset), std::ios::beg);
-    if (!stream) {
-        throw std::runtime_error("Failed to seek to IMAG chunk.");
-    }
-
-    const damb::ImageChunkHeader image_header = amb::utility::readPod<damb::ImageChunkHeader>(stream, "IMAG header");
+SurfacePtr DambLoader::decodeImageSurface(const amb::utility::ByteSpan& image_chunk, const damb::TocEntry& image_entry) const {
+    AMB_PROFILE_SCOPE("damb image decode");
+    const damb::ImageChunkHeader image_header = amb::utility::readPod<damb::ImageChunkHeader>(image_chunk, 0, "IMAG header");
     if (!amb::utility::chunkTypeEquals(image_header.header.type, damb::CL_IMAGE)) {
         throw std::runtime_error("TOC IMAG entry points to a non-IMAG chunk.");
     }
@@ -33,8 +26,8 @@ ImageRuntime DambLoader::loadImageRuntime(std::ifstream& stream, const damb::Toc
         throw std::runtime_error("TOC IMAG entry id does not match IMAG chunk header id.");
     }
 
-    if (image_header.format != damb::ImageFormat::png) {
-        throw std::runtime_error("Only PNG IMAG chunk format is supported.");
+    if (image_header.format != damb::ImageFormat::png && image_header.format != damb::ImageFormat::rgba) {
+        throw std::runtime_error("Unsupported IMAG chunk format.");
     }
 
     if (image_header.size == 0) {
@@ -46,24 +39,97 @@ ImageRuntime DambLoader::loadImageRuntime(std::ifstream& stream, const damb::Toc
     }
 
     const u64 expected_chunk_size = static_cast<u64>(damb::IMAG_HEADER_SIZE) + image_header.size;
-    if (image_entry.size < expected_chunk_size) {
-        throw std::runtime_error("IMAG TOC size is smaller than declared IMAG payload.");
+    if (static_cast<u64>(image_chunk.size()) < expected_chunk_size) {
+        throw std::runtime_error("IMAG chunk size is smaller than declared IMAG payload.");
     }
 
-    std::vector<u8> image_blob(static_cast<std::size_t>(image_header.size));
-    stream.read(reinterpret_cast<char*>(image_blob.data()), static_cast<std::streamsize>(image_blob.size()));
-    if (!stream) {
-        throw std::runtime_error("Failed to read IMAG payload.");
+    // the payload is read straight out of the file mapping (or the scratch arena for compressed chunks)
+    const amb::utility::ByteSpan image_blob = image_chunk.subspan(damb::IMAG_HEADER_SIZE, image_header.size, "IMAG payload");
+
+    if (image_header.format == damb::ImageFormat::rgba) {
+        return copyRgbaSurface(image_blob, image_header);
     }
 
-    SDL_IOStream* image_io = SDL_IOFromConstMem(image_blob.data(), static_cast<int>(image_blob.size()));
+    SDL_IOStream* image_io = SDL_IOFromConstMem(image_blob.data(), image_blob.size());
     if (image_io == nullptr) {
         throw std::runtime_error(std::string("Failed to open IMAG payload as SDL IO stream: ") + SDL_GetError());
     }
 
-    SDL_Texture* raw_texture = IMG_LoadTexture_IO(renderer, image_io, true);
+    // decoding to a surface needs no renderer, so this half can run on a loader thread
+    SurfacePtr surface(IMG_Load_IO(image_io, true));
+    if (surface == nullptr) {
+        throw std::runtime_error(std::string("Failed to decode IMAG payload: ") + SDL_GetError());
+    }
+
+    return surface;
+}
+
+SurfacePtr DambLoader::copyRgbaSurface(const amb::utility::ByteSpan& pixels, const damb::ImageChunkHeader& image_header) const {
+    if (image_header.width == 0 || image_header.height == 0 ||
+        image_header.width > static_cast<u32>(std::numeric_limits<int>::max()) ||
+        image_header.height > static_cast<u32>(std::numeric_limits<int>::max())) {
+        throw std::runtime_error("IMAG rgba chunk has invalid dimensions.");
+    }
+
+    const u64 row_size = static_cast<u64>(image_header.width) * damb::IMAG_RGBA_BYTES_PER_PIXEL;
+    if (image_header.pitch < row_size || image_header.pitch % damb::IMAG_RGBA_BYTES_PER_PIXEL != 0) {
+        throw std::runtime_error("IMAG rgba chunk has an invalid row pitch.");
+    }
+
+    if (static_cast<u64>(image_header.pitch) * image_header.height != pixels.size()) {
+        throw std::runtime_error("IMAG rgba payload size does not match pitch * height.");
+    }
+
+    SurfacePtr surface(SDL_CreateSurface(
+        static_cast<int>(image_header.width),
+        static_cast<int>(image_header.height),
+        SDL_PIXELFORMAT_ABGR8888));
+    if (surface == nullptr) {
+        throw std::runtime_error(std::string("Failed to allocate IMAG surface: ") + SDL_GetError());
+    }
+
+    // no decode: rows are copied as stored, in one block when the pitches agree
+    auto* dst = static_cast<u8*>(surface->pixels);
+    if (static_cast<u32>(surface->pitch) == image_header.pitch) {
+        std::memcpy(dst, pixels.data(), pixels.size());
+    } else {
+        for (u32 y = 0; y < image_header.height; y++) {
+            std::memcpy(
+                dst + static_cast<std::size_t>(y) * static_cast<std::size_t>(surface->pitch),
+                pixels.data() + static_cast<std::size_t>(y) * image_header.pitch,
+                static_cast<std::size_t>(row_size));
+        }
+    }
+
+    return surface;
+}
+
+ImageRuntime DambLoader::uploadImageRuntime(SDL_Surface* surface, SDL_Renderer* renderer) const {
+    AMB_PROFILE_SCOPE("damb image upload");
+    if (renderer == nullptr) {
+        throw std::runtime_error("Cannot load IMAG chunk without a valid SDL_Renderer.");
+    }
+
+    if (surface == nullptr) {
+        throw std::runtime_error("Cannot upload IMAG chunk without a decoded surface.");
+    }
+
+    // ABGR8888 pixels go to the texture as-is; anything else (paletted or RGB PNGs) takes SDL's converting path
+    SDL_Texture* raw_texture = nullptr;
+    if (surface->format == SDL_PIXELFORMAT_ABGR8888) {
+        raw_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_STATIC, surface->w, surface->h);
+        if (raw_texture != nullptr && !SDL_UpdateTexture(raw_texture, nullptr, surface->pixels, surface->pitch)) {
+            SDL_DestroyTexture(raw_texture);
+            raw_texture = nullptr;
+        }
+    }
+
+    if (raw_texture == nullptr) {
+        raw_texture = SDL_CreateTextureFromSurface(renderer, surface);
+    }
+
     if (raw_texture == nullptr) {
-        throw std::runtime_error(std::string("Failed to decode IMAG payload into texture: ") + SDL_GetError());
+        throw std::runtime_error(std::string("Failed to upload IMAG payload into texture: ") + SDL_GetError());
     }
 
     ImageRuntime image_runtime {};
@@ -1,20 +1,124 @@
 #include "damb_loader.hxx"
 
 #include "utility_binary.hxx"
+#include "utility_profile.hxx"
+#include "utility_simd.hxx"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
 #include <stdexcept>
+#include <vector>
 
 namespace {
     namespace damb = amb::damb;
-}
 
-damb::MapLayerChunkHeader DambLoader::loadMapLayerHeader(std::ifstream& stream, const damb::TocEntry& map_entry) const {
-    stream.seekg(static_cast<std::streamoff>(map_entry.offset), std::ios::beg);
-    if (!stream) {
-        throw std::runtime_error("Failed to seek to MAPL chunk.");
+    static_assert(offsetof(damb::MapCell, atlas_record_index) == 2, "MAPL cell decode expects atlas_record_index in the high u16.");
+
+    u16 decodeRawCells(const amb::utility::ByteSpan& payload, std::vector<Cell>& cells) {
+        const u64 expected_payload_size = static_cast<u64>(cells.size()) * static_cast<u64>(damb::MAPCELL_SIZE);
+        if (payload.size() != expected_payload_size) {
+            throw std::runtime_error("MAPL payload size does not match width/height cell count.");
+        }
+
+        // one pass over the mapped payload: pull atlas_record_index out of every MapCell and track the largest
+        return amb::utility::gatherHighU16WithMax(payload.data(), cells.size(), cells.data());
     }
 
-    const damb::MapLayerChunkHeader map_header = amb::utility::readPod<damb::MapLayerChunkHeader>(stream, "MAPL header");
+    u16 decodeRunLengthCells(const amb::utility::ByteSpan& payload, std::vector<Cell>& cells) {
+        if ((payload.size() % damb::MAPRUN_SIZE) != 0) {
+            throw std::runtime_error("MAPL run_length payload size is not aligned to MapRun size.");
+        }
+
+        const amb::utility::PodSpan<damb::MapRun> runs = amb::utility::viewPodArray<damb::MapRun>(
+            payload,
+            0,
+            payload.size() / damb::MAPRUN_SIZE,
+            "MAPL runs");
+
+        u16 max_atlas_index = 0;
+        std::size_t cursor = 0;
+
+        for (const damb::MapRun& run : runs) {
+            if (run.length == 0 || run.length > cells.size() - cursor) {
+                throw std::runtime_error("MAPL run length is zero or overflows the map cell count.");
+            }
+
+            std::fill_n(cells.begin() + static_cast<std::ptrdiff_t>(cursor), run.length, run.cell.atlas_record_index);
+            max_atlas_index = std::max(max_atlas_index, run.cell.atlas_record_index);
+            cursor += run.length;
+        }
+
+        if (cursor != cells.size()) {
+            throw std::runtime_error("MAPL run lengths do not cover width/height cell count.");
+        }
+
+        return max_atlas_index;
+    }
+
+    u16 decodePaletteCells(const amb::utility::ByteSpan& payload, std::vector<Cell>& cells) {
+        const damb::MapPaletteHeader palette_header = amb::utility::readPod<damb::MapPaletteHeader>(payload, 0, "MAPL palette header");
+
+        const u8 index_bits = palette_header.index_bits;
+        if (index_bits == 0 || index_bits > 32 || (index_bits & (index_bits - 1)) != 0) {
+            throw std::runtime_error("MAPL palette index_bits must be a power of two no larger than 32.");
+        }
+
+        if (palette_header.palette_count == 0 || static_cast<u64>(palette_header.palette_count) > (u64{1} << index_bits)) {
+            throw std::runtime_error("MAPL palette_count is empty or not addressable with index_bits.");
+        }
+
+        const amb::utility::PodSpan<damb::MapCell> palette = amb::utility::viewPodArray<damb::MapCell>(
+            payload,
+            damb::MAPPALETTE_HEADER_SIZE,
+            palette_header.palette_count,
+            "MAPL palette");
+
+        const u64 words_offset = static_cast<u64>(damb::MAPPALETTE_HEADER_SIZE) + (static_cast<u64>(palette.size()) * damb::MAPCELL_SIZE);
+        const u64 word_count = damb::PaletteWordCount(cells.size(), index_bits);
+        const amb::utility::ByteSpan words = payload.subspan(words_offset, "MAPL palette indices");
+        if (words.size() != word_count * sizeof(u64)) {
+            throw std::runtime_error("MAPL palette index payload size does not match width/height cell count.");
+        }
+
+        std::vector<Cell> lookup(palette.size());
+        u16 max_atlas_index = 0;
+        for (std::size_t i = 0; i < palette.size(); i++) {
+            lookup[i] = palette[i].atlas_record_index;
+            max_atlas_index = std::max(max_atlas_index, lookup[i]);
+        }
+
+        const u64 mask = (u64{1} << index_bits) - 1;
+        const u32 last_index = palette_header.palette_count - 1;
+        const std::size_t per_word = 64u / index_bits;
+
+        // indices are clamped into the palette while decoding and the true maximum is checked once at the end
+        u32 max_index = 0;
+        std::size_t cursor = 0;
+        for (u64 w = 0; w < word_count; w++) {
+            u64 word = 0;
+            std::memcpy(&word, words.data() + (w * sizeof(u64)), sizeof(word));
+
+            const std::size_t count = std::min(per_word, cells.size() - cursor);
+            for (std::size_t k = 0; k < count; k++) {
+                const u32 index = static_cast<u32>(word & mask);
+                word >>= index_bits;
+
+                max_index = std::max(max_index, index);
+                cells[cursor++] = lookup[std::min(index, last_index)];
+            }
+        }
+
+        if (max_index > last_index) {
+            throw std::runtime_error("MAPL palette index out of range for palette_count.");
+        }
+
+        return max_atlas_index;
+    }
+}
+
+damb::MapLayerChunkHeader DambLoader::loadMapLayerHeader(const amb::utility::ByteSpan& map_chunk, const damb::TocEntry& map_entry) const {
+    const damb::MapLayerChunkHeader map_header = amb::utility::readPod<damb::MapLayerChunkHeader>(map_chunk, 0, "MAPL header");
     if (!amb::utility::chunkTypeEquals(map_header.header.type, damb::CL_MAP_LAYER)) {
         throw std::runtime_error("TOC MAPL entry points to a non-MAPL chunk.");
     }
@@ -23,47 +127,48 @@ damb::MapLayerChunkHeader DambLoader::loadMapLayerHeader(std::ifstream& stream,
         throw std::runtime_error("TOC MAPL entry id does not match MAPL chunk header id.");
     }
 
-    if (map_header.encoding != damb::MapEncoding::raw) {
-        throw std::runtime_error("Only raw map encoding is supported.");
+    if (map_header.encoding != damb::MapEncoding::raw &&
+        map_header.encoding != damb::MapEncoding::run_length &&
+        map_header.encoding != damb::MapEncoding::palette) {
+        throw std::runtime_error("Unsupported MAPL map encoding.");
     }
 
-    if (map_entry.size < damb::MAPL_HEADER_SIZE) {
-        throw std::runtime_error("MAPL TOC size is smaller than MAPL header size.");
+    if (map_chunk.size() < damb::MAPL_HEADER_SIZE) {
+        throw std::runtime_error("MAPL chunk size is smaller than MAPL header size.");
     }
 
     return map_header;
 }
 
 MapRuntime DambLoader::loadMapRuntime(
-    std::ifstream& stream,
-    const damb::TocEntry& map_entry,
+    const amb::utility::ByteSpan& map_chunk,
     const damb::MapLayerChunkHeader& map_header,
     const AtlasChunkMetadata& atlas_metadata) const
 {
+    AMB_PROFILE_SCOPE("damb map cells");
     const std::size_t cell_count = checkedCellCount(map_header.width, map_header.height);
-    const u64 expected_payload_size = checkedMapPayloadSize(cell_count);
-    const u64 map_payload_size = map_entry.size - static_cast<u64>(damb::MAPL_HEADER_SIZE);
-    if (map_payload_size != expected_payload_size) {
-        throw std::runtime_error("MAPL payload size does not match width/height cell count.");
-    }
-
-    stream.seekg(static_cast<std::streamoff>(map_entry.offset + damb::MAPL_HEADER_SIZE), std::ios::beg);
-    if (!stream) {
-        throw std::runtime_error("Failed to seek to MAPL cells.");
+    const amb::utility::ByteSpan payload = map_chunk.subspan(damb::MAPL_HEADER_SIZE, "MAPL payload");
+
+    std::vector<Cell> cells(cell_count);
+    u16 max_atlas_index = 0;
+
+    switch (map_header.encoding) {
+        case damb::MapEncoding::raw:
+            max_atlas_index = decodeRawCells(payload, cells);
+            break;
+        case damb::MapEncoding::run_length:
+            max_atlas_index = decodeRunLengthCells(payload, cells);
+            break;
+        case damb::MapEncoding::palette:
+            max_atlas_index = decodePaletteCells(payload, cells);
+            break;
     }
 
-    MapRuntime map_runtime(map_header.width, map_header.height);
-    map_runtime.reserveCells(cell_count);
-
-    for (std::size_t i = 0; i < cell_count; ++i) {
-        const damb::MapCell cell = amb::utility::readPod<damb::MapCell>(stream, "MAPL cell");
-
-        if (cell.atlas_record_index >= atlas_metadata.asset_count) {
-            throw std::runtime_error("MAPL cell atlas_record_index out of range for referenced atlas.");
-        }
-
-        map_runtime.appendCell(cell.atlas_record_index);
+    if (static_cast<u32>(max_atlas_index) >= atlas_metadata.asset_count) {
+        throw std::runtime_error("MAPL cell atlas_record_index out of range for referenced atlas.");
     }
 
+    MapRuntime map_runtime(map_header.width, map_header.height, std::move(cells));
+    map_runtime.setLayout(m_cell_layout);
     return map_runtime;
 }
@@ -7,11 +7,15 @@
 
 namespace amb::damb {
     enum class MapEncoding : u8 {
-        raw = 0
+        raw = 0,
+        run_length = 1,
+        palette = 2
     };
 
     constexpr u16 MAPCELL_SIZE = 4;
     constexpr u16 MAPL_HEADER_SIZE = 28;
+    constexpr u16 MAPRUN_SIZE = 8;
+    constexpr u16 MAPPALETTE_HEADER_SIZE = 8;
 
     struct MapCell {
         u16 id = 0;
@@ -20,6 +24,37 @@ namespace amb::damb {
     static_assert(sizeof(MapCell) == MAPCELL_SIZE, "MapCell size does not match stated value.");
     static_assert(std::is_trivially_copyable_v<MapCell>, "MapCell must be POD/trivially copyable.");
 
+    // run_length payload: MapRun records in row-major order, run lengths summing to width * height
+    struct MapRun {
+        u32 length = 0;
+        MapCell cell;
+    };
+    static_assert(sizeof(MapRun) == MAPRUN_SIZE, "MapRun size does not match stated value.");
+    static_assert(std::is_trivially_copyable_v<MapRun>, "MapRun must be POD/trivially copyable.");
+
+    // palette payload: MapPaletteHeader, MapCell[palette_count], then one index per cell packed
+    // LSB-first into little-endian u64 words. index_bits is a power of two so indices never straddle words.
+    struct MapPaletteHeader {
+        u32 palette_count = 0;
+        u8 index_bits = 0;
+        u8 reserved[3] = {};
+    };
+    static_assert(sizeof(MapPaletteHeader) == MAPPALETTE_HEADER_SIZE, "MapPaletteHeader size does not match stated value.");
+    static_assert(std::is_trivially_copyable_v<MapPaletteHeader>, "MapPaletteHeader must be POD/trivially copyable.");
+
+    constexpr u8 PaletteIndexBits(u32 palette_count) {
+        u8 bits = 1;
+        while (bits < 32 && (u64{1} << bits) < palette_count) {
+            bits = static_cast<u8>(bits * 2);
+        }
+        return bits;
+    }
+
+    constexpr u64 PaletteWordCount(u64 cell_count, u8 index_bits) {
+        const u64 per_word = 64u / index_bits;
+        return (cell_count + per_word - 1) / per_word;
+    }
+
     struct MapLayerChunkHeader {
         ChunkHeader header;
 
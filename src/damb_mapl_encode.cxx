@@ -0,0 +1,98 @@
+#include "damb_mapl_encode.hxx"
+
+#include "utility_binary.hxx"
+
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+
+namespace amb::damb {
+    EncodedMapPayload encodeRawCells(const std::vector<MapCell>& cells) {
+        EncodedMapPayload payload {MapEncoding::raw, {}};
+        payload.bytes.reserve(cells.size() * MAPCELL_SIZE);
+
+        for (const MapCell& cell : cells) {
+            amb::utility::appendPod(payload.bytes, cell);
+        }
+
+        return payload;
+    }
+
+    EncodedMapPayload encodeRunLengthCells(const std::vector<MapCell>& cells) {
+        EncodedMapPayload payload {MapEncoding::run_length, {}};
+
+        std::size_t i = 0;
+        while (i < cells.size()) {
+            MapRun run {};
+            run.cell = cells[i];
+
+            while (i < cells.size() &&
+                   cells[i].id == run.cell.id &&
+                   cells[i].atlas_record_index == run.cell.atlas_record_index &&
+                   run.length < std::numeric_limits<u32>::max()) {
+                run.length++;
+                i++;
+            }
+
+            amb::utility::appendPod(payload.bytes, run);
+        }
+
+        return payload;
+    }
+
+    EncodedMapPayload encodePaletteCells(const std::vector<MapCell>& cells) {
+        EncodedMapPayload payload {MapEncoding::palette, {}};
+
+        std::vector<MapCell> palette;
+        std::unordered_map<u32, u32> palette_slots;
+        std::vector<u32> indices;
+        indices.reserve(cells.size());
+
+        for (const MapCell& cell : cells) {
+            const u32 key = (static_cast<u32>(cell.id) << 16) | cell.atlas_record_index;
+            const auto [slot, inserted] = palette_slots.try_emplace(key, static_cast<u32>(palette.size()));
+            if (inserted) {
+                palette.push_back(cell);
+            }
+            indices.push_back(slot->second);
+        }
+
+        MapPaletteHeader header {};
+        header.palette_count = static_cast<u32>(palette.size());
+        header.index_bits = PaletteIndexBits(header.palette_count);
+
+        amb::utility::appendPod(payload.bytes, header);
+        for (const MapCell& cell : palette) {
+            amb::utility::appendPod(payload.bytes, cell);
+        }
+
+        const std::size_t per_word = 64u / header.index_bits;
+        for (std::size_t base = 0; base < indices.size(); base += per_word) {
+            u64 word = 0;
+            const std::size_t count = std::min(per_word, indices.size() - base);
+            for (std::size_t k = 0; k < count; k++) {
+                word |= static_cast<u64>(indices[base + k]) << (k * header.index_bits);
+            }
+            amb::utility::appendPod(payload.bytes, word);
+        }
+
+        return payload;
+    }
+
+    EncodedMapPayload encodeSmallestCells(const std::vector<MapCell>& cells) {
+        EncodedMapPayload encoded = encodeRawCells(cells);
+
+        EncodedMapPayload run_length = encodeRunLengthCells(cells);
+        if (run_length.bytes.size() < encoded.bytes.size()) {
+            encoded = std::move(run_length);
+        }
+
+        EncodedMapPayload palette = encodePaletteCells(cells);
+        if (palette.bytes.size() < encoded.bytes.size()) {
+            encoded = std::move(palette);
+        }
+
+        return encoded;
+    }
+}
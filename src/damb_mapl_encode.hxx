@@ -0,0 +1,23 @@
+#ifndef DAMB_MAPL_ENCODE_HXX_INCLUDED
+#define DAMB_MAPL_ENCODE_HXX_INCLUDED
+
+#include "damb_mapl.hxx"
+
+#include <vector>
+
+// MAPL payload encoders shared by the pack writer and the benchmark corpus generator
+namespace amb::damb {
+    struct EncodedMapPayload {
+        MapEncoding encoding = MapEncoding::raw;
+        std::vector<u8> bytes;
+    };
+
+    EncodedMapPayload encodeRawCells(const std::vector<MapCell>& cells);
+    EncodedMapPayload encodeRunLengthCells(const std::vector<MapCell>& cells);
+    EncodedMapPayload encodePaletteCells(const std::vector<MapCell>& cells);
+
+    // whichever of the three is smallest; ties favour the cheaper decoder
+    EncodedMapPayload encodeSmallestCells(const std::vector<MapCell>& cells);
+}
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef DAMB_MASK_HXX_INCLUDED
+#define DAMB_MASK_HXX_INCLUDED
+
+#include "damb_format.hxx"
+
+#include <type_traits>
+
+namespace amb::damb {
+    constexpr u16 MASK_HEADER_SIZE = 16;
+    constexpr u16 MASK_RECORD_SIZE = 8;
+
+    // one bit per pixel of an atlas record, set where alpha >= MaskChunkHeader::alpha_threshold. each row
+    // takes ceil(width / 64) u64 words starting at `first_word`; bit 0 is the leftmost pixel, padding bits are 0
+    struct MaskRecord {
+        u16 width = 0;
+        u16 height = 0;
+        u32 first_word = 0;
+    };
+    static_assert(sizeof(MaskRecord) == MASK_RECORD_SIZE, "MaskRecord size does not match stated value.");
+    static_assert(std::is_trivially_copyable_v<MaskRecord>, "MaskRecord must be POD/trivially copyable.");
+
+    // a MASK chunk extends the ATLS chunk with the same id and is stored after it, one record per
+    // AtlasRecord; payload: MaskRecord[record_count], then u64[word_count]
+    struct MaskChunkHeader {
+        ChunkHeader header;
+        u8 alpha_threshold = 0;
+        u8 reserved = 0;
+        u32 record_count = 0;
+        u32 word_count = 0;
+    };
+    static_assert(sizeof(MaskChunkHeader) == MASK_HEADER_SIZE, "MaskChunkHeader size does not match stated value.");
+    static_assert(std::is_trivially_copyable_v<MaskChunkHeader>, "MaskChunkHeader must be POD/trivially copyable.");
+}
+
+#endif
@@ -0,0 +1,162 @@
+#include "damb_preloader.hxx"
+
+#include "utility_profile.hxx"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+    namespace damb = amb::damb;
+}
+
+DambPreloader::DambPreloader(const DambLoader& loader, const std::size_t worker_count)
+: m_loader(loader),
+  m_worker_count(std::max<std::size_t>(worker_count, 1)) {}
+
+DambPreloader::~DambPreloader() {
+    stop();
+}
+
+void DambPreloader::start(const std::filesystem::path& file_path) {
+    if (m_active) {
+        throw std::runtime_error("DAMB preloader is already loading " + m_path.string() + ".");
+    }
+
+    stop();
+
+    m_path = file_path;
+    m_cancelled = false;
+    m_slots.clear();
+    m_entities.clear();
+    m_listed = false;
+    m_error = nullptr;
+    m_next_upload = 0;
+
+    m_active = true;
+    m_thread = std::thread(&DambPreloader::run, this);
+}
+
+void DambPreloader::stop() noexcept {
+    m_cancelled = true;
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+
+    m_active = false;
+}
+
+void DambPreloader::run() {
+    AMB_PROFILE_THREAD("preload");
+    try {
+        const DambFile file = m_loader.openFile(m_path);
+
+        const std::vector<const damb::TocEntry*> map_entries = file.chunksOfType(damb::CL_MAP_LAYER);
+        if (map_entries.empty()) {
+            throw std::runtime_error("No MAPL chunk found in file.");
+        }
+
+        // small next to the layers, so entities are ready before the first layer is handed out
+        amb::utility::ScratchArena entity_scratch;
+        amb::entity::EntityStore entities = m_loader.loadEntityStore(file, entity_scratch);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_entities = std::move(entities);
+            m_slots.resize(map_entries.size());
+            m_listed = true;
+        }
+
+        // layers are handed out one at a time; each worker keeps its own scratch arena
+        std::atomic<std::size_t> next_layer {0};
+        const auto worker = [this, &file, &map_entries, &next_layer]() {
+            AMB_PROFILE_THREAD("preload worker");
+            amb::utility::ScratchArena scratch;
+
+            try {
+                for (std::size_t i = next_layer++; i < map_entries.size() && !m_cancelled; i = next_layer++) {
+                    DambLoader::PreparedMapLayer prepared = m_loader.prepareMapLayer(file, *map_entries[i], scratch);
+
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_slots[i].emplace(std::move(prepared));
+                }
+            } catch (...) {
+                m_cancelled = true;
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_error == nullptr) {
+                    m_error = std::current_exception();
+                }
+            }
+        };
+
+        const std::size_t thread_count = std::min(m_worker_count, map_entries.size());
+        std::vector<std::thread> threads;
+        threads.reserve(thread_count - 1);
+        for (std::size_t i = 1; i < thread_count; i++) {
+            threads.emplace_back(worker);
+        }
+
+        worker();
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_error == nullptr) {
+            m_error = std::current_exception();
+        }
+    }
+}
+
+bool DambPreloader::pump(SDL_Renderer* renderer, const u64 budget_ns, std::vector<VisualLayerPtr>& out) {
+    if (!m_active) {
+        return false;
+    }
+
+    AMB_PROFILE_SCOPE("preload pump");
+    const u64 start_ns = SDL_GetTicksNS();
+
+    while (true) {
+        std::optional<DambLoader::PreparedMapLayer> prepared;
+        std::exception_ptr error;
+        bool done = false;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            error = m_error;
+            done = m_listed && m_next_upload == m_slots.size();
+            if (m_next_upload < m_slots.size() && m_slots[m_next_upload].has_value()) {
+                prepared = std::move(m_slots[m_next_upload]);
+                m_slots[m_next_upload].reset();
+            }
+        }
+
+        if (error != nullptr) {
+            stop();
+            std::rethrow_exception(error);
+        }
+
+        if (done) {
+            stop();
+            return false;
+        }
+
+        if (!prepared.has_value()) {
+            return true;
+        }
+
+        out.push_back(m_loader.finishMapLayer(renderer, std::move(*prepared)));
+        m_next_upload++;
+
+        // whatever is left waits for the next frame
+        if (SDL_GetTicksNS() - start_ns >= budget_ns) {
+            return true;
+        }
+    }
+}
+
+amb::entity::EntityStore DambPreloader::takeEntities() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return std::move(m_entities);
+}
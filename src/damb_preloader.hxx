@@ -0,0 +1,61 @@
+#ifndef DAMB_PRELOADER_HXX_INCLUDED
+#define DAMB_PRELOADER_HXX_INCLUDED
+
+#include "damb_loader.hxx"
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+// loads a .damb file off the main thread: worker threads parse chunks and decode images,
+// the main thread only uploads finished layers to the GPU from pump()
+class DambPreloader {
+public:
+    // `loader` must outlive the preloader; its settings apply to every start()
+    DambPreloader(const DambLoader& loader, std::size_t worker_count);
+    ~DambPreloader();
+
+    DambPreloader(const DambPreloader&) = delete;
+    DambPreloader& operator=(const DambPreloader&) = delete;
+
+    // begins loading in the background; a preloader runs one file at a time
+    void start(const std::filesystem::path& file_path);
+
+    // uploads ready layers in MAPL order until `budget_ns` is spent (always at least one when ready);
+    // rethrows the loader's error, returns false once every layer has been handed out
+    bool pump(SDL_Renderer* renderer, u64 budget_ns, std::vector<VisualLayerPtr>& out);
+
+    // the file's entities, moved out once pump() has returned false
+    amb::entity::EntityStore takeEntities();
+
+    bool active() const noexcept { return m_active; }
+    const std::filesystem::path& path() const noexcept { return m_path; }
+
+private:
+    void run();
+    void stop() noexcept;
+
+    const DambLoader& m_loader;
+    std::size_t m_worker_count = 1;
+
+    std::filesystem::path m_path;
+    std::thread m_thread;
+    std::atomic<bool> m_cancelled {false};
+    bool m_active = false;
+
+    // guarded by m_mutex; slots are filled by the workers in any order and drained in order
+    std::mutex m_mutex;
+    std::vector<std::optional<DambLoader::PreparedMapLayer>> m_slots;
+    amb::entity::EntityStore m_entities;  // loaded before the layers are listed
+    bool m_listed = false;
+    std::exception_ptr m_error;
+
+    std::size_t m_next_upload = 0;
+};
+
+#endif
@@ -1,7 +1,9 @@
 #ifndef DAMB_SPEC_HXX_INCLUDED
 #define DAMB_SPEC_HXX_INCLUDED
 
+#include "damb_anim.hxx"
 #include "damb_atls.hxx"
+#include "damb_ents.hxx"
 #include "damb_imag.hxx"
 #include "damb_mapl.hxx"
 
@@ -15,12 +17,23 @@ namespace amb::damb {
         u32 width = 0;
         u32 height = 0;
         ImageFormat format = ImageFormat::png;
+        u32 row_alignment = 4;  // rgba rows are padded to a multiple of this many bytes
+        ChunkCompression compression = ChunkCompression::none;
+    };
+
+    // cells holding `atlas_record_index` cycle through `frames`; written to the atlas's ANIM chunk
+    struct AnimationSpec {
+        u16 atlas_record_index = 0;
+        std::vector<AnimationFrame> frames;
     };
 
     struct AtlasSpec {
         u16 id = 0;
         u16 image_id = 0;
         std::vector<AtlasRecord> records;
+        std::vector<AnimationSpec> animations;
+        u8 mask_alpha = 0;  // alpha threshold of the MASK chunk; 0 writes none
+        ChunkCompression compression = ChunkCompression::none;
     };
 
     struct MapSpec {
@@ -30,6 +43,14 @@ namespace amb::damb {
         u32 height = 0;
         i32 z = 0;
         std::vector<u16> tile_ids;
+        ChunkCompression compression = ChunkCompression::none;
+    };
+
+    struct EntitiesSpec {
+        u16 id = 0;
+        u16 map_id = 0;
+        std::vector<EntityRecord> records;
+        ChunkCompression compression = ChunkCompression::none;
     };
 
     struct ManifestSpec {
@@ -37,10 +58,12 @@ namespace amb::damb {
         ImageSpec image;
         AtlasSpec atlas;
         MapSpec map;
+        EntitiesSpec entities;
         bool has_output = false;
         bool has_image = false;
         bool has_atlas = false;
         bool has_map = false;
+        bool has_entities = false;
     };
 }
 
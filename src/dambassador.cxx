@@ -1,19 +1,33 @@
 #include "dambassador.hxx"
 
+#include "damb_anim.hxx"
 #include "damb_atls.hxx"
+#include "damb_ents.hxx"
+#include "damb_file.hxx"
 #include "damb_imag.hxx"
 #include "damb_mapl.hxx"
+#include "damb_mapl_encode.hxx"
+#include "damb_mask.hxx"
 #include "damb_format.hxx"
 
 #include "utility_binary.hxx"
+#include "utility_crc.hxx"
+#include "utility_lz.hxx"
 #include "utility_parse.hxx"
 #include "utility_string.hxx"
 
+#include <SDL3_image/SDL_image.h>
+
+#include <algorithm>
+#include <chrono>
 #include <cstring>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <limits>
 #include <stdexcept>
 #include <string>
+#include <thread>
 
 namespace amb {
     namespace {
@@ -22,6 +36,7 @@ namespace amb {
             atlas,
             map,
             rows,
+            entities,
         };
 
         void parseAtlasTileRecord(
@@ -62,6 +77,126 @@ namespace amb {
             }
         }
 
+        // frames=<record>:<ms>,<record>:<ms>...
+        void parseAnimationFrames(damb::AnimationSpec& animation, const std::string& value, std::size_t line_number) {
+            for (const std::string& frame_token : utility::split(value, ',')) {
+                const std::vector<std::string> parts = utility::split(utility::trim(frame_token), ':');
+                if (parts.size() != 2) {
+                    throw std::runtime_error("Line " + std::to_string(line_number) + ": anim frame must be <record>:<ms>, got: " + frame_token);
+                }
+
+                damb::AnimationFrame frame {};
+                frame.atlas_record_index = utility::parseUnsigned16(utility::trim(parts[0]), line_number, "anim frame record");
+                frame.duration_ms = utility::parseUnsigned32(utility::trim(parts[1]), line_number, "anim frame duration");
+                if (frame.duration_ms == 0) {
+                    throw std::runtime_error("Line " + std::to_string(line_number) + ": anim frame duration must be greater than zero.");
+                }
+                animation.frames.push_back(frame);
+            }
+        }
+
+        void validateAnimations(const damb::AtlasSpec& atlas) {
+            std::vector<bool> animated(atlas.records.size(), false);
+            for (const damb::AnimationSpec& animation : atlas.animations) {
+                if (animation.atlas_record_index >= atlas.records.size()) {
+                    throw std::runtime_error(
+                        "Animation record index " + std::to_string(animation.atlas_record_index) +
+                        " is out of range for atlas record count " + std::to_string(atlas.records.size()) + ".");
+                }
+                if (animated[animation.atlas_record_index]) {
+                    throw std::runtime_error(
+                        "Atlas record " + std::to_string(animation.atlas_record_index) + " is animated more than once.");
+                }
+                animated[animation.atlas_record_index] = true;
+
+                u64 cycle_ms = 0;
+                for (const damb::AnimationFrame& frame : animation.frames) {
+                    if (frame.atlas_record_index >= atlas.records.size()) {
+                        throw std::runtime_error(
+                            "Animation frame record " + std::to_string(frame.atlas_record_index) +
+                            " is out of range for atlas record count " + std::to_string(atlas.records.size()) + ".");
+                    }
+                    cycle_ms += frame.duration_ms;
+                }
+                if (cycle_ms > std::numeric_limits<u32>::max()) {
+                    throw std::runtime_error(
+                        "Animation of atlas record " + std::to_string(animation.atlas_record_index) + " is too long.");
+                }
+            }
+        }
+
+        // entity <id> <player|npc> tile=<x>,<y> [heading=<deg>] [speed=<px/s>] [flags=<bits>]
+        void parseEntityRecord(damb::EntityRecord& record, const std::vector<std::string>& tokens, std::size_t line_number) {
+            if (tokens[2] == "player") {
+                record.type = damb::EntityType::player;
+            } else if (tokens[2] == "npc") {
+                record.type = damb::EntityType::npc;
+            } else {
+                throw std::runtime_error("Line " + std::to_string(line_number) + ": entity type must be player or npc, got: " + tokens[2]);
+            }
+
+            bool has_tile = false;
+            for (std::size_t i = 3; i < tokens.size(); i++) {
+                const auto [key, value] = utility::parseKeyValue(tokens[i], line_number);
+
+                if (key == "tile") {
+                    const std::vector<std::string> values = utility::split(value, ',');
+                    if (values.size() != 2) {
+                        throw std::runtime_error("Line " + std::to_string(line_number) + ": tile requires x,y.");
+                    }
+                    record.tile_x = utility::parseUnsigned16(utility::trim(values[0]), line_number, "entity tile x");
+                    record.tile_y = utility::parseUnsigned16(utility::trim(values[1]), line_number, "entity tile y");
+                    has_tile = true;
+                } else if (key == "heading") {
+                    record.heading = static_cast<float>(utility::parseSigned32(value, line_number, "entity heading"));
+                } else if (key == "speed") {
+                    record.speed = static_cast<float>(utility::parseUnsigned32(value, line_number, "entity speed"));
+                } else if (key == "flags") {
+                    const u32 flags = utility::parseUnsigned32(value, line_number, "entity flags");
+                    if ((flags & ~static_cast<u32>(damb::ENTS_RECORD_FLAG_MASK)) != 0) {
+                        throw std::runtime_error("Line " + std::to_string(line_number) + ": entity sets unknown flags.");
+                    }
+                    record.flags = static_cast<u8>(flags);
+                } else {
+                    throw std::runtime_error("Line " + std::to_string(line_number) + ": unknown entity field: " + key);
+                }
+            }
+
+            if (!has_tile) {
+                throw std::runtime_error("Line " + std::to_string(line_number) + ": entity is missing tile=x,y.");
+            }
+        }
+
+        void validateEntities(const damb::ManifestSpec& manifest) {
+            const damb::EntitiesSpec& entities = manifest.entities;
+            if (entities.map_id != manifest.map.id) {
+                throw std::runtime_error("Entities map dependency does not match declared map id.");
+            }
+
+            std::vector<bool> used_ids(static_cast<std::size_t>(std::numeric_limits<u16>::max()) + 1, false);
+            bool has_player = false;
+            for (const damb::EntityRecord& record : entities.records) {
+                if (record.id == std::numeric_limits<u16>::max()) {
+                    throw std::runtime_error("Entity id " + std::to_string(record.id) + " is reserved.");
+                }
+                if (used_ids[record.id]) {
+                    throw std::runtime_error("Entity id " + std::to_string(record.id) + " is used more than once.");
+                }
+                used_ids[record.id] = true;
+
+                if (record.tile_x >= manifest.map.width || record.tile_y >= manifest.map.height) {
+                    throw std::runtime_error("Entity " + std::to_string(record.id) + " spawns outside the map.");
+                }
+
+                if (record.type == damb::EntityType::player) {
+                    if (has_player) {
+                        throw std::runtime_error("Entities define more than one player.");
+                    }
+                    has_player = true;
+                }
+            }
+        }
+
         void validateManifest(const damb::ManifestSpec& manifest, ManifestParseState state, bool saw_manifest_header) {
             if (!saw_manifest_header) {
                 throw std::runtime_error("Manifest is empty or missing `damb_manifest 1` header.");
@@ -101,12 +236,36 @@ namespace amb {
                     );
                 }
             }
+
+            validateAnimations(manifest.atlas);
+            if (manifest.has_entities) {
+                validateEntities(manifest);
+            }
+        }
+
+        damb::ChunkCompression parseCompressionToken(const std::string& token, std::size_t line_number) {
+            const auto [key, value] = utility::parseKeyValue(token, line_number);
+            if (key != "compress") {
+                throw std::runtime_error("Line " + std::to_string(line_number) + ": expected compress=<none|lz4>, got: " + token);
+            }
+
+            if (value == "none") {
+                return damb::ChunkCompression::none;
+            }
+            if (value == "lz4") {
+                return damb::ChunkCompression::lz4;
+            }
+
+            throw std::runtime_error("Line " + std::to_string(line_number) + ": unsupported chunk compression: " + value);
         }
 
         damb::ImageFormat parseImageFormatValue(const std::string& value, std::size_t line_number) {
             if (value == "png") {
                 return damb::ImageFormat::png;
             }
+            if (value == "rgba") {
+                return damb::ImageFormat::rgba;
+            }
 
             throw std::runtime_error("Line " + std::to_string(line_number) + ": unsupported image format: " + value);
         }
@@ -188,10 +347,14 @@ namespace amb {
                 if (keyword == "image") { parseImage(tokens); return; }
                 if (keyword == "atlas") { parseAtlasStart(tokens); return; }
                 if (keyword == "tile") { parseTile(tokens); return; }
+                if (keyword == "anim") { parseAnimation(tokens); return; }
                 if (keyword == "endatlas") { parseAtlasEnd(tokens); return; }
                 if (keyword == "map") { parseMapStart(tokens); return; }
                 if (keyword == "rows") { parseRowsStart(tokens); return; }
                 if (keyword == "endmap") { parseMapEnd(tokens); return; }
+                if (keyword == "ents") { parseEntitiesStart(tokens); return; }
+                if (keyword == "entity") { parseEntity(tokens); return; }
+                if (keyword == "endents") { parseEntitiesEnd(tokens); return; }
 
                 throw std::runtime_error("Line " + std::to_string(m_line_number) + ": unknown statement: " + keyword);
             }
@@ -206,8 +369,8 @@ namespace amb {
             }
 
             void parseImage(const std::vector<std::string>& tokens) {
-                if (m_state != ManifestParseState::top || tokens.size() != 6) {
-                    throw std::runtime_error("Line " + std::to_string(m_line_number) + ": image line must be `image <id> <path> <width> <height> <format>`.");
+                if (m_state != ManifestParseState::top || tokens.size() < 6 || tokens.size() > 8) {
+                    throw std::runtime_error("Line " + std::to_string(m_line_number) + ": image line must be `image <id> <path> <width> <height> <format> [row_align=<bytes>] [compress=<mode>]`.");
                 }
 
                 m_manifest.image.id = utility::parseUnsigned16(tokens[1], m_line_number, "image id");
@@ -215,12 +378,30 @@ namespace amb {
                 m_manifest.image.width = utility::parseUnsigned32(tokens[3], m_line_number, "image width");
                 m_manifest.image.height = utility::parseUnsigned32(tokens[4], m_line_number, "image height");
                 m_manifest.image.format = parseImageFormatValue(tokens[5], m_line_number);
+
+                for (std::size_t i = 6; i < tokens.size(); i++) {
+                    const auto [key, value] = utility::parseKeyValue(tokens[i], m_line_number);
+                    if (key == "compress") {
+                        m_manifest.image.compression = parseCompressionToken(tokens[i], m_line_number);
+                    } else if (key == "row_align") {
+                        const u32 row_alignment = utility::parseUnsigned32(value, m_line_number, "image row_align");
+                        if (row_alignment < damb::IMAG_RGBA_BYTES_PER_PIXEL || (row_alignment & (row_alignment - 1)) != 0) {
+                            throw std::runtime_error("Line " + std::to_string(m_line_number) + ": image row_align must be a power of two of at least 4.");
+                        }
+                        if (m_manifest.image.format != damb::ImageFormat::rgba) {
+                            throw std::runtime_error("Line " + std::to_string(m_line_number) + ": image row_align only applies to rgba images.");
+                        }
+                        m_manifest.image.row_alignment = row_alignment;
+                    } else {
+                        throw std::runtime_error("Line " + std::to_string(m_line_number) + ": unsupported image option: " + key);
+                    }
+                }
                 m_manifest.has_image = true;
             }
 
             void parseAtlasStart(const std::vector<std::string>& tokens) {
-                if (m_state != ManifestParseState::top || tokens.size() != 3) {
-                    throw std::runtime_error("Line " + std::to_string(m_line_number) + ": atlas line must be `atlas <id> image=<image_id>`.");
+                if (m_state != ManifestParseState::top || tokens.size() < 3 || tokens.size() > 5) {
+                    throw std::runtime_error("Line " + std::to_string(m_line_number) + ": atlas line must be `atlas <id> image=<image_id> [masks=<alpha>] [compress=<mode>]`.");
                 }
 
                 m_manifest.atlas = damb::AtlasSpec {};
@@ -233,6 +414,30 @@ namespace amb {
 
                 m_manifest.atlas.image_id = utility::parseUnsigned16(value, m_line_number, "atlas image_id");
                 m_manifest.atlas.records.clear();
+                bool has_masks = false;
+                bool has_compress = false;
+                for (std::size_t i = 3; i < tokens.size(); i++) {
+                    const auto [option, option_value] = utility::parseKeyValue(tokens[i], m_line_number);
+                    if (option != "masks" && option != "compress") {
+                        throw std::runtime_error("Line " + std::to_string(m_line_number) + ": unsupported atlas option: " + option);
+                    }
+
+                    bool& seen = (option == "masks") ? has_masks : has_compress;
+                    if (seen) {
+                        throw std::runtime_error("Line " + std::to_string(m_line_number) + ": duplicate atlas option: " + option);
+                    }
+                    seen = true;
+
+                    if (option == "masks") {
+                        const u16 alpha = utility::parseUnsigned16(option_value, m_line_number, "atlas mask alpha");
+                        if (alpha == 0 || alpha > 0xFF) {
+                            throw std::runtime_error("Line " + std::to_string(m_line_number) + ": atlas masks=<alpha> must be within 1..255.");
+                        }
+                        m_manifest.atlas.mask_alpha = static_cast<u8>(alpha);
+                    } else {
+                        m_manifest.atlas.compression = parseCompressionToken(tokens[i], m_line_number);
+                    }
+                }
                 m_manifest.has_atlas = true;
                 m_state = ManifestParseState::atlas;
             }
@@ -257,6 +462,29 @@ namespace amb {
                 m_manifest.atlas.records.push_back(record);
             }
 
+            void parseAnimation(const std::vector<std::string>& tokens) {
+                if (m_state != ManifestParseState::atlas) {
+                    throw std::runtime_error("Line " + std::to_string(m_line_number) + ": anim entry is only valid inside atlas block.");
+                }
+                if (tokens.size() != 3) {
+                    throw std::runtime_error("Line " + std::to_string(m_line_number) + ": anim line must be `anim <record> frames=<record>:<ms>,...`.");
+                }
+
+                damb::AnimationSpec animation {};
+                animation.atlas_record_index = utility::parseUnsigned16(tokens[1], m_line_number, "anim record");
+
+                const auto [key, value] = utility::parseKeyValue(tokens[2], m_line_number);
+                if (key != "frames") {
+                    throw std::runtime_error("Line " + std::to_string(m_line_number) + ": anim line must include frames=<record>:<ms>,...");
+                }
+                parseAnimationFrames(animation, value, m_line_number);
+
+                if (animation.frames.size() > std::numeric_limits<u16>::max()) {
+                    throw std::runtime_error("Line " + std::to_string(m_line_number) + ": anim has too many frames.");
+                }
+                m_manifest.atlas.animations.push_back(std::move(animation));
+            }
+
             void parseAtlasEnd(const std::vector<std::string>& tokens) {
                 if (m_state != ManifestParseState::atlas || tokens.size() != 1) {
                     throw std::runtime_error("Line " + std::to_string(m_line_number) + ": unexpected endatlas.");
@@ -266,8 +494,8 @@ namespace amb {
             }
 
             void parseMapStart(const std::vector<std::string>& tokens) {
-                if (m_state != ManifestParseState::top || tokens.size() != 6) {
-                    throw std::runtime_error("Line " + std::to_string(m_line_number) + ": map line must be `map <id> atlas=<id> width=<w> height=<h> z=<z>`." );
+                if (m_state != ManifestParseState::top || (tokens.size() != 6 && tokens.size() != 7)) {
+                    throw std::runtime_error("Line " + std::to_string(m_line_number) + ": map line must be `map <id> atlas=<id> width=<w> height=<h> z=<z> [compress=<mode>]`." );
                 }
 
                 m_manifest.map = damb::MapSpec {};
@@ -283,6 +511,8 @@ namespace amb {
                         m_manifest.map.height = utility::parseUnsigned32(value, m_line_number, "map height");
                     } else if (key == "z") {
                         m_manifest.map.z = utility::parseSigned32(value, m_line_number, "map z");
+                    } else if (key == "compress") {
+                        m_manifest.map.compression = parseCompressionToken(tokens[i], m_line_number);
                     } else {
                         throw std::runtime_error("Line " + std::to_string(m_line_number) + ": unknown map field: " + key);
                     }
@@ -309,6 +539,49 @@ namespace amb {
                 m_state = ManifestParseState::top;
             }
 
+            void parseEntitiesStart(const std::vector<std::string>& tokens) {
+                if (m_state != ManifestParseState::top || m_manifest.has_entities || (tokens.size() != 3 && tokens.size() != 4)) {
+                    throw std::runtime_error("Line " + std::to_string(m_line_number) + ": ents line must be a single `ents <id> map=<map_id> [compress=<mode>]` at top scope.");
+                }
+
+                m_manifest.entities = damb::EntitiesSpec {};
+                m_manifest.entities.id = utility::parseUnsigned16(tokens[1], m_line_number, "ents id");
+
+                const auto [key, value] = utility::parseKeyValue(tokens[2], m_line_number);
+                if (key != "map") {
+                    throw std::runtime_error("Line " + std::to_string(m_line_number) + ": ents line must include map=<map_id>.");
+                }
+
+                m_manifest.entities.map_id = utility::parseUnsigned16(value, m_line_number, "ents map_id");
+                if (tokens.size() == 4) {
+                    m_manifest.entities.compression = parseCompressionToken(tokens[3], m_line_number);
+                }
+                m_manifest.has_entities = true;
+                m_state = ManifestParseState::entities;
+            }
+
+            void parseEntity(const std::vector<std::string>& tokens) {
+                if (m_state != ManifestParseState::entities) {
+                    throw std::runtime_error("Line " + std::to_string(m_line_number) + ": entity entry is only valid inside ents block.");
+                }
+                if (tokens.size() < 4) {
+                    throw std::runtime_error("Line " + std::to_string(m_line_number) + ": entity line must be `entity <id> <player|npc> tile=<x>,<y> [heading=<deg>] [speed=<px/s>] [flags=<bits>]`.");
+                }
+
+                damb::EntityRecord record {};
+                record.id = utility::parseUnsigned16(tokens[1], m_line_number, "entity id");
+                parseEntityRecord(record, tokens, m_line_number);
+                m_manifest.entities.records.push_back(record);
+            }
+
+            void parseEntitiesEnd(const std::vector<std::string>& tokens) {
+                if (m_state != ManifestParseState::entities || tokens.size() != 1) {
+                    throw std::runtime_error("Line " + std::to_string(m_line_number) + ": unexpected endents.");
+                }
+
+                m_state = ManifestParseState::top;
+            }
+
             damb::ManifestSpec m_manifest {};
             ManifestParseState m_state = ManifestParseState::top;
             std::size_t m_line_number = 0;
@@ -326,7 +599,54 @@ namespace amb {
     }
 
     void Dambassador::inspect(const std::filesystem::path& damb_path) const {
-        std::cout << "inspect not implemented for: " << damb_path.string() << '\n';
+        const DambFile file(damb_path);
+        const damb::Header& header = file.header();
+
+        std::cout << damb_path.string() << ": DAMB v" << header.version
+                  << ", " << header.file_size << " bytes, " << header.toc_count << " chunks"
+                  << (file.hasChunkChecksums() ? ", chunk CRC32" : ", no chunk checksums") << '\n';
+
+        const std::size_t worker_count = std::max(1u, std::thread::hardware_concurrency());
+
+        const auto started = std::chrono::steady_clock::now();
+        const std::vector<u32> checksums = file.computeChecksums(worker_count);
+        const auto finished = std::chrono::steady_clock::now();
+
+        u64 total_bytes = 0;
+        std::size_t mismatches = 0;
+
+        for (std::size_t i = 0; i < file.toc().size(); i++) {
+            const damb::TocEntry& entry = file.toc()[i];
+            total_bytes += entry.size;
+
+            const bool matches = !file.hasChunkChecksums() || checksums[i] == entry.crc32;
+            if (!matches) {
+                mismatches++;
+            }
+
+            std::cout << "  " << std::string(entry.type, amb::data::CHUNK_TYPE_LENGTH)
+                      << " id=" << std::setw(5) << std::left << entry.id << std::right
+                      << " offset=" << std::setw(10) << entry.offset
+                      << " size=" << std::setw(10) << entry.size
+                      << " raw=" << std::setw(10) << entry.uncompressed_size
+                      << " crc=" << std::hex << std::setfill('0') << std::setw(8) << checksums[i]
+                      << std::dec << std::setfill(' ')
+                      << (matches ? "  ok" : "  MISMATCH") << '\n';
+        }
+
+        const double seconds = std::chrono::duration<double>(finished - started).count();
+        const double megabytes = static_cast<double>(total_bytes) / (1024.0 * 1024.0);
+
+        std::cout << "Checked " << total_bytes << " bytes in " << (seconds * 1000.0) << " ms on "
+                  << worker_count << " threads";
+        if (seconds > 0.0) {
+            std::cout << " (" << (megabytes / seconds) << " MiB/s)";
+        }
+        std::cout << '\n';
+
+        if (mismatches > 0) {
+            throw std::runtime_error(std::to_string(mismatches) + " chunk(s) failed CRC verification.");
+        }
     }
 
     void Dambassador::printUsage(std::ostream& out) {
@@ -340,6 +660,9 @@ namespace amb {
         if (value == "png") {
             return damb::ImageFormat::png;
         }
+        if (value == "rgba") {
+            return damb::ImageFormat::rgba;
+        }
 
         throw std::runtime_error("Line " + std::to_string(line_number) + ": unsupported image format: " + value);
     }
@@ -371,6 +694,48 @@ namespace amb {
         return bytes;
     }
 
+    std::vector<u8> Dambassador::readRgbaPixels(
+        const std::filesystem::path& path,
+        const damb::ImageSpec& image,
+        u32& pitch
+    ) const {
+        SurfacePtr decoded(IMG_Load(path.string().c_str()));
+        if (decoded == nullptr) {
+            throw std::runtime_error("Failed to decode image " + path.string() + ": " + SDL_GetError());
+        }
+
+        if (static_cast<u32>(decoded->w) != image.width || static_cast<u32>(decoded->h) != image.height) {
+            throw std::runtime_error(
+                "Image " + path.string() + " is " + std::to_string(decoded->w) + "x" + std::to_string(decoded->h) +
+                ", manifest declares " + std::to_string(image.width) + "x" + std::to_string(image.height) + ".");
+        }
+
+        SurfacePtr pixels(SDL_ConvertSurface(decoded.get(), SDL_PIXELFORMAT_ABGR8888));
+        if (pixels == nullptr) {
+            throw std::runtime_error("Failed to convert image " + path.string() + " to RGBA: " + SDL_GetError());
+        }
+
+        const u64 row_size = static_cast<u64>(image.width) * damb::IMAG_RGBA_BYTES_PER_PIXEL;
+        const u64 aligned_pitch = (row_size + image.row_alignment - 1) & ~static_cast<u64>(image.row_alignment - 1);
+        if (aligned_pitch > std::numeric_limits<u32>::max()) {
+            throw std::runtime_error("Image " + path.string() + " is too wide for an rgba IMAG chunk.");
+        }
+        pitch = static_cast<u32>(aligned_pitch);
+
+        std::vector<u8> bytes(static_cast<std::size_t>(aligned_pitch * image.height), 0);
+        if (!SDL_LockSurface(pixels.get())) {
+            throw std::runtime_error("Failed to lock image " + path.string() + ": " + SDL_GetError());
+        }
+
+        const auto* src = static_cast<const u8*>(pixels->pixels);
+        for (u32 y = 0; y < image.height; y++) {
+            std::memcpy(bytes.data() + static_cast<std::size_t>(y) * pitch, src + static_cast<std::size_t>(y) * pixels->pitch, row_size);
+        }
+        SDL_UnlockSurface(pixels.get());
+
+        return bytes;
+    }
+
     Dambassador::ChunkBlob Dambassador::buildImageChunk(
         const damb::ManifestSpec& manifest,
         const std::filesystem::path& base_dir
@@ -378,16 +743,19 @@ namespace amb {
         ChunkBlob chunk;
 
         const std::filesystem::path image_path = base_dir / manifest.image.file_path;
-        const std::vector<u8> image_bytes = readFileBytes(image_path);
 
         damb::ImageChunkHeader header {};
         std::memcpy(header.header.type, damb::CL_IMAGE, amb::data::CHUNK_TYPE_LENGTH);
         header.header.id = manifest.image.id;
-        header.size = static_cast<u64>(image_bytes.size());
         header.width = manifest.image.width;
         header.height = manifest.image.height;
         header.format = manifest.image.format;
 
+        const std::vector<u8> image_bytes = (manifest.image.format == damb::ImageFormat::rgba)
+            ? readRgbaPixels(image_path, manifest.image, header.pitch)
+            : readFileBytes(image_path);
+        header.size = static_cast<u64>(image_bytes.size());
+
         utility::appendPod(chunk.bytes, header);
         chunk.bytes.insert(chunk.bytes.end(), image_bytes.begin(), image_bytes.end());
 
@@ -395,12 +763,66 @@ namespace amb {
         chunk.toc.id = manifest.image.id;
         chunk.toc.size = chunk.bytes.size();
         chunk.toc.uncompressed_size = chunk.toc.size;
+        chunk.toc.crc32 = utility::crc32(chunk.bytes.data(), chunk.bytes.size());
         return chunk;
     }
 
-    Dambassador::ChunkBlob Dambassador::buildAtlasChunk(const damb::ManifestSpec& manifest) const {
+    SurfacePtr Dambassador::readAbgrSurface(const std::filesystem::path& image_path) const {
+        SurfacePtr decoded(IMG_Load(image_path.string().c_str()));
+        if (decoded == nullptr) {
+            throw std::runtime_error("Failed to decode image " + image_path.string() + ": " + SDL_GetError());
+        }
+
+        SurfacePtr pixels(SDL_ConvertSurface(decoded.get(), SDL_PIXELFORMAT_ABGR8888));
+        if (pixels == nullptr) {
+            throw std::runtime_error("Failed to convert image " + image_path.string() + " to RGBA: " + SDL_GetError());
+        }
+
+        return pixels;
+    }
+
+    void Dambassador::markOpaqueRecords(std::vector<damb::AtlasRecord>& records, const std::filesystem::path& image_path) const {
+        SurfacePtr pixels = readAbgrSurface(image_path);
+        if (!SDL_LockSurface(pixels.get())) {
+            throw std::runtime_error("Failed to read alpha of image " + image_path.string() + ": " + SDL_GetError());
+        }
+
+        const auto* src = static_cast<const u8*>(pixels->pixels);
+        for (damb::AtlasRecord& record : records) {
+            const u32 right = static_cast<u32>(record.src_x) + record.src_w;
+            const u32 bottom = static_cast<u32>(record.src_y) + record.src_h;
+
+            // rects reaching outside the image sample nothing there, so they never count as opaque
+            bool opaque = record.src_w > 0 && record.src_h > 0 &&
+                right <= static_cast<u32>(pixels->w) && bottom <= static_cast<u32>(pixels->h);
+
+            for (u32 y = record.src_y; opaque && y < bottom; y++) {
+                const u8* row = src + static_cast<std::size_t>(y) * static_cast<std::size_t>(pixels->pitch);
+                for (u32 x = record.src_x; x < right; x++) {
+                    if (row[x * damb::IMAG_RGBA_BYTES_PER_PIXEL + 3] != 0xFF) {
+                        opaque = false;
+                        break;
+                    }
+                }
+            }
+
+            record.flags = opaque
+                ? (record.flags | damb::ATLS_RECORD_FLAG_OPAQUE)
+                : (record.flags & ~damb::ATLS_RECORD_FLAG_OPAQUE);
+        }
+
+        SDL_UnlockSurface(pixels.get());
+    }
+
+    Dambassador::ChunkBlob Dambassador::buildAtlasChunk(
+        const damb::ManifestSpec& manifest,
+        const std::filesystem::path& base_dir
+    ) const {
         ChunkBlob chunk;
 
+        std::vector<damb::AtlasRecord> records = manifest.atlas.records;
+        markOpaqueRecords(records, base_dir / manifest.image.file_path);
+
         damb::AtlasChunkHeader header {};
         std::memcpy(header.header.type, damb::CL_ATLAS, amb::data::CHUNK_TYPE_LENGTH);
         header.header.id = manifest.atlas.id;
@@ -408,7 +830,7 @@ namespace amb {
         header.image_id = manifest.atlas.image_id;
 
         utility::appendPod(chunk.bytes, header);
-        for (const damb::AtlasRecord& record : manifest.atlas.records) {
+        for (const damb::AtlasRecord& record : records) {
             utility::appendPod(chunk.bytes, record);
         }
 
@@ -416,6 +838,122 @@ namespace amb {
         chunk.toc.id = manifest.atlas.id;
         chunk.toc.size = chunk.bytes.size();
         chunk.toc.uncompressed_size = chunk.toc.size;
+        chunk.toc.crc32 = utility::crc32(chunk.bytes.data(), chunk.bytes.size());
+        return chunk;
+    }
+
+    Dambassador::ChunkBlob Dambassador::buildAnimationChunk(const damb::ManifestSpec& manifest) const {
+        ChunkBlob chunk;
+
+        damb::AnimationChunkHeader header {};
+        std::memcpy(header.header.type, damb::CL_ANIMATION, amb::data::CHUNK_TYPE_LENGTH);
+        header.header.id = manifest.atlas.id;
+        header.sequence_count = static_cast<u32>(manifest.atlas.animations.size());
+
+        std::vector<damb::AnimationSequence> sequences;
+        sequences.reserve(manifest.atlas.animations.size());
+        for (const damb::AnimationSpec& animation : manifest.atlas.animations) {
+            damb::AnimationSequence sequence {};
+            sequence.atlas_record_index = animation.atlas_record_index;
+            sequence.frame_count = static_cast<u16>(animation.frames.size());
+            sequence.first_frame = header.frame_count;
+            sequences.push_back(sequence);
+            header.frame_count += static_cast<u32>(animation.frames.size());
+        }
+
+        utility::appendPod(chunk.bytes, header);
+        for (const damb::AnimationSequence& sequence : sequences) {
+            utility::appendPod(chunk.bytes, sequence);
+        }
+        for (const damb::AnimationSpec& animation : manifest.atlas.animations) {
+            for (const damb::AnimationFrame& frame : animation.frames) {
+                utility::appendPod(chunk.bytes, frame);
+            }
+        }
+
+        std::memcpy(chunk.toc.type, damb::CL_ANIMATION, amb::data::CHUNK_TYPE_LENGTH);
+        chunk.toc.id = manifest.atlas.id;
+        chunk.toc.size = chunk.bytes.size();
+        chunk.toc.uncompressed_size = chunk.toc.size;
+        chunk.toc.crc32 = utility::crc32(chunk.bytes.data(), chunk.bytes.size());
+        return chunk;
+    }
+
+    Dambassador::ChunkBlob Dambassador::buildMaskChunk(
+        const damb::ManifestSpec& manifest,
+        const std::filesystem::path& base_dir
+    ) const {
+        ChunkBlob chunk;
+
+        const std::filesystem::path image_path = base_dir / manifest.image.file_path;
+        SurfacePtr pixels = readAbgrSurface(image_path);
+        if (!SDL_LockSurface(pixels.get())) {
+            throw std::runtime_error("Failed to read alpha of image " + image_path.string() + ": " + SDL_GetError());
+        }
+
+        damb::MaskChunkHeader header {};
+        std::memcpy(header.header.type, damb::CL_MASK, amb::data::CHUNK_TYPE_LENGTH);
+        header.header.id = manifest.atlas.id;
+        header.alpha_threshold = manifest.atlas.mask_alpha;
+        header.record_count = static_cast<u32>(manifest.atlas.records.size());
+
+        std::vector<damb::MaskRecord> mask_records;
+        std::vector<u64> words;
+        mask_records.reserve(manifest.atlas.records.size());
+
+        const auto* src = static_cast<const u8*>(pixels->pixels);
+        const u32 image_width = static_cast<u32>(pixels->w);
+        const u32 image_height = static_cast<u32>(pixels->h);
+        for (const damb::AtlasRecord& record : manifest.atlas.records) {
+            damb::MaskRecord mask_record {};
+            mask_record.width = record.src_w;
+            mask_record.height = record.src_h;
+            mask_record.first_word = static_cast<u32>(words.size());
+
+            const std::size_t words_per_row = (static_cast<std::size_t>(record.src_w) + 63) / 64;
+            if (words.size() + words_per_row * record.src_h > std::numeric_limits<u32>::max()) {
+                throw std::runtime_error("Atlas " + std::to_string(manifest.atlas.id) + " masks exceed the MASK word limit.");
+            }
+
+            // pixels of rects reaching outside the image stay clear, matching what the renderer samples there
+            for (u32 y = 0; y < record.src_h; y++) {
+                const std::size_t row_start = words.size();
+                words.resize(row_start + words_per_row, 0);
+
+                const u32 image_y = static_cast<u32>(record.src_y) + y;
+                if (image_y >= image_height) {
+                    continue;
+                }
+
+                const u8* row = src + static_cast<std::size_t>(image_y) * static_cast<std::size_t>(pixels->pitch);
+                for (u32 x = 0; x < record.src_w; x++) {
+                    const u32 image_x = static_cast<u32>(record.src_x) + x;
+                    if (image_x < image_width &&
+                        row[image_x * damb::IMAG_RGBA_BYTES_PER_PIXEL + 3] >= manifest.atlas.mask_alpha) {
+                        words[row_start + x / 64] |= u64 {1} << (x % 64);
+                    }
+                }
+            }
+
+            mask_records.push_back(mask_record);
+        }
+
+        SDL_UnlockSurface(pixels.get());
+        header.word_count = static_cast<u32>(words.size());
+
+        utility::appendPod(chunk.bytes, header);
+        for (const damb::MaskRecord& mask_record : mask_records) {
+            utility::appendPod(chunk.bytes, mask_record);
+        }
+        for (const u64 word : words) {
+            utility::appendPod(chunk.bytes, word);
+        }
+
+        std::memcpy(chunk.toc.type, damb::CL_MASK, amb::data::CHUNK_TYPE_LENGTH);
+        chunk.toc.id = manifest.atlas.id;
+        chunk.toc.size = chunk.bytes.size();
+        chunk.toc.uncompressed_size = chunk.toc.size;
+        chunk.toc.crc32 = utility::crc32(chunk.bytes.data(), chunk.bytes.size());
         return chunk;
     }
 
@@ -429,30 +967,89 @@ namespace amb {
         header.height = manifest.map.height;
         header.z = manifest.map.z;
         header.atlas_id = manifest.map.atlas_id;
-        header.encoding = damb::MapEncoding::raw;
-
-        utility::appendPod(chunk.bytes, header);
 
+        std::vector<damb::MapCell> cells;
+        cells.reserve(manifest.map.tile_ids.size());
         for (const u16 atlas_record_index : manifest.map.tile_ids) {
             damb::MapCell cell {};
             cell.id = 0;
             cell.atlas_record_index = atlas_record_index;
-            utility::appendPod(chunk.bytes, cell);
+            cells.push_back(cell);
         }
 
+        const damb::EncodedMapPayload encoded = damb::encodeSmallestCells(cells);
+
+        header.encoding = encoded.encoding;
+
+        utility::appendPod(chunk.bytes, header);
+        chunk.bytes.insert(chunk.bytes.end(), encoded.bytes.begin(), encoded.bytes.end());
+
         std::memcpy(chunk.toc.type, damb::CL_MAP_LAYER, amb::data::CHUNK_TYPE_LENGTH);
         chunk.toc.id = manifest.map.id;
         chunk.toc.size = chunk.bytes.size();
         chunk.toc.uncompressed_size = chunk.toc.size;
+        chunk.toc.crc32 = utility::crc32(chunk.bytes.data(), chunk.bytes.size());
+        return chunk;
+    }
+
+    Dambassador::ChunkBlob Dambassador::buildEntityChunk(const damb::ManifestSpec& manifest) const {
+        ChunkBlob chunk;
+
+        damb::EntityChunkHeader header {};
+        std::memcpy(header.header.type, damb::CL_ENTITY, amb::data::CHUNK_TYPE_LENGTH);
+        header.header.id = manifest.entities.id;
+        header.map_id = manifest.entities.map_id;
+        header.entity_count = static_cast<u32>(manifest.entities.records.size());
+
+        utility::appendPod(chunk.bytes, header);
+        for (const damb::EntityRecord& record : manifest.entities.records) {
+            utility::appendPod(chunk.bytes, record);
+        }
+
+        std::memcpy(chunk.toc.type, damb::CL_ENTITY, amb::data::CHUNK_TYPE_LENGTH);
+        chunk.toc.id = manifest.entities.id;
+        chunk.toc.size = chunk.bytes.size();
+        chunk.toc.uncompressed_size = chunk.toc.size;
+        chunk.toc.crc32 = utility::crc32(chunk.bytes.data(), chunk.bytes.size());
+        return chunk;
+    }
+
+    Dambassador::ChunkBlob Dambassador::compressChunk(ChunkBlob chunk, const damb::ChunkCompression compression) const {
+        if (compression == damb::ChunkCompression::none) {
+            return chunk;
+        }
+
+        std::vector<u8> compressed = utility::lzCompress(chunk.bytes.data(), chunk.bytes.size());
+
+        // incompressible chunks are stored as-is so the loader never pays for a useless decode
+        if (compressed.size() >= chunk.bytes.size()) {
+            return chunk;
+        }
+
+        chunk.toc.uncompressed_size = chunk.bytes.size();
+        chunk.toc.size = compressed.size();
+        chunk.toc.flags = (chunk.toc.flags & ~damb::TOC_FLAG_COMPRESSION_MASK) | static_cast<u32>(compression);
+        chunk.bytes = std::move(compressed);
+        chunk.toc.crc32 = utility::crc32(chunk.bytes.data(), chunk.bytes.size());
         return chunk;
     }
 
     void Dambassador::writeDamb(const damb::ManifestSpec& manifest, const std::filesystem::path& manifest_path) const {
         const std::filesystem::path base_dir = manifest_path.parent_path();
         std::vector<ChunkBlob> chunks;
-        chunks.push_back(buildImageChunk(manifest, base_dir));
-        chunks.push_back(buildAtlasChunk(manifest));
-        chunks.push_back(buildMapChunk(manifest));
+        chunks.push_back(compressChunk(buildImageChunk(manifest, base_dir), manifest.image.compression));
+        chunks.push_back(compressChunk(buildAtlasChunk(manifest, base_dir), manifest.atlas.compression));
+        if (!manifest.atlas.animations.empty()) {
+            chunks.push_back(compressChunk(buildAnimationChunk(manifest), manifest.atlas.compression));
+        }
+        if (manifest.atlas.mask_alpha != 0) {
+            chunks.push_back(compressChunk(buildMaskChunk(manifest, base_dir), manifest.atlas.compression));
+        }
+        chunks.push_back(compressChunk(buildMapChunk(manifest), manifest.map.compression));
+        if (manifest.has_entities) {
+            // the loader resolves ENTS against a MAPL chunk stored before it
+            chunks.push_back(compressChunk(buildEntityChunk(manifest), manifest.entities.compression));
+        }
 
         u64 cursor = damb::HEADER_SIZE;
         for (ChunkBlob& chunk : chunks) {
@@ -471,7 +1068,7 @@ namespace amb {
         header.toc_offset = toc_offset;
         header.toc_count = toc_count;
         header.toc_entry_size = damb::TOC_ENTRY_SIZE;
-        header.flags = 0;
+        header.flags = damb::HEADER_FLAG_CHUNK_CRC32;
         header.version = damb::VERSION;
 
         const std::filesystem::path output_path = base_dir / manifest.output_path;
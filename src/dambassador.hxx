@@ -28,10 +28,22 @@ namespace amb {
         damb::ImageFormat parseImageFormat(const std::string& value, std::size_t line_number) const;
 
         std::vector<u8> readFileBytes(const std::filesystem::path& path) const;
+        // decodes an image into ABGR8888 rows padded to `image.row_alignment`; writes the row pitch
+        std::vector<u8> readRgbaPixels(const std::filesystem::path& path, const damb::ImageSpec& image, u32& pitch) const;
 
         ChunkBlob buildImageChunk(const damb::ManifestSpec& manifest, const std::filesystem::path& base_dir) const;
-        ChunkBlob buildAtlasChunk(const damb::ManifestSpec& manifest) const;
+        // decodes an image into an ABGR8888 surface, so alpha is byte 3 of every pixel
+        SurfacePtr readAbgrSurface(const std::filesystem::path& image_path) const;
+        // sets or clears ATLS_RECORD_FLAG_OPAQUE on every record from the decoded image's alpha
+        void markOpaqueRecords(std::vector<damb::AtlasRecord>& records, const std::filesystem::path& image_path) const;
+
+        ChunkBlob buildAtlasChunk(const damb::ManifestSpec& manifest, const std::filesystem::path& base_dir) const;
+        ChunkBlob buildAnimationChunk(const damb::ManifestSpec& manifest) const;
+        // one bitmask per atlas record, set where the image's alpha reaches manifest.atlas.mask_alpha
+        ChunkBlob buildMaskChunk(const damb::ManifestSpec& manifest, const std::filesystem::path& base_dir) const;
         ChunkBlob buildMapChunk(const damb::ManifestSpec& manifest) const;
+        ChunkBlob buildEntityChunk(const damb::ManifestSpec& manifest) const;
+        ChunkBlob compressChunk(ChunkBlob chunk, damb::ChunkCompression compression) const;
 
         void writeDamb(const damb::ManifestSpec& manifest, const std::filesystem::path& manifest_path) const;
     };
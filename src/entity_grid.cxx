@@ -0,0 +1,187 @@
+#include "entity_grid.hxx"
+
+#include "config.hxx"
+#include "utility_profile.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace amb::entity {
+    namespace {
+        constexpr u32 NO_CELL = std::numeric_limits<u32>::max();
+        constexpr float INFINITE = std::numeric_limits<float>::infinity();
+
+        // inclusive cell span covering [low, high) world pixels, clamped to the grid. scales exactly like
+        // cellColumn/cellRow, so an entity is never binned past the last cell a query reaches
+        void cellSpan(float low, float high, float inverse_cell_size, std::size_t count, std::size_t& first, std::size_t& last) noexcept {
+            const float max_index = static_cast<float>(count - 1);
+            first = static_cast<std::size_t>(std::clamp(low * inverse_cell_size, 0.0f, max_index));
+            last = static_cast<std::size_t>(std::clamp(high * inverse_cell_size, 0.0f, max_index));
+        }
+    }
+
+    void SpatialGrid::reset(const std::size_t map_width, const std::size_t map_height, const std::size_t cell_tiles) {
+        m_cell_tiles = std::max<std::size_t>(cell_tiles, 1);
+        m_columns = std::max<std::size_t>((map_width + m_cell_tiles - 1) / m_cell_tiles, 1);
+        m_rows = std::max<std::size_t>((map_height + m_cell_tiles - 1) / m_cell_tiles, 1);
+        m_inverse_cell_size = 1.0f / static_cast<float>(m_cell_tiles * amb::game::MAP_TILE_SIZE);
+        m_heads.assign(m_columns * m_rows, INVALID_ENTITY_ID);
+        m_next.clear();
+        m_prev.clear();
+        m_cell.clear();
+    }
+
+    void SpatialGrid::clear() noexcept {
+        std::fill(m_heads.begin(), m_heads.end(), INVALID_ENTITY_ID);
+        m_next.clear();
+        m_prev.clear();
+        m_cell.clear();
+    }
+
+    void SpatialGrid::update(const EntityStore& store) {
+        AMB_PROFILE_SCOPE("entity grid");
+        const float* world_x = store.worldX();
+        const float* world_y = store.worldY();
+
+        for (std::size_t slot = 0; slot < store.size(); slot++) {
+            const EntityId id = store.id(slot);
+            if (id >= m_cell.size()) {
+                m_next.resize(static_cast<std::size_t>(id) + 1, INVALID_ENTITY_ID);
+                m_prev.resize(static_cast<std::size_t>(id) + 1, INVALID_ENTITY_ID);
+                m_cell.resize(static_cast<std::size_t>(id) + 1, NO_CELL);
+            }
+
+            const std::size_t cell = cellOf(world_x[slot], world_y[slot]);
+            if (m_cell[id] == cell) {
+                continue;
+            }
+
+            if (m_cell[id] != NO_CELL) {
+                unlink(id);
+            }
+            link(id, cell);
+        }
+    }
+
+    void SpatialGrid::remove(const EntityId id) noexcept {
+        if (id < m_cell.size() && m_cell[id] != NO_CELL) {
+            unlink(id);
+        }
+    }
+
+    std::size_t SpatialGrid::queryRect(
+        const EntityStore& store,
+        const float left,
+        const float top,
+        const float right,
+        const float bottom,
+        EntityView& view) const
+    {
+        view.visible_count = 0;
+        if (!(left < right) || !(top < bottom) || store.empty()) {
+            return 0;
+        }
+
+        if (view.slots.size() < store.size()) {
+            view.slots.resize(store.size());
+        }
+
+        std::size_t first_column = 0;
+        std::size_t last_column = 0;
+        std::size_t first_row = 0;
+        std::size_t last_row = 0;
+        cellSpan(left, right, m_inverse_cell_size, m_columns, first_column, last_column);
+        cellSpan(top, bottom, m_inverse_cell_size, m_rows, first_row, last_row);
+
+        const float* world_x = store.worldX();
+        const float* world_y = store.worldY();
+        for (std::size_t row = first_row; row <= last_row; row++) {
+            for (std::size_t column = first_column; column <= last_column; column++) {
+                for (EntityId id = m_heads[row * m_columns + column]; id != INVALID_ENTITY_ID; id = m_next[id]) {
+                    const std::size_t slot = store.slotOf(id);
+                    if (slot == NO_SLOT) {
+                        continue;
+                    }
+
+                    const float x = world_x[slot];
+                    const float y = world_y[slot];
+                    if (x >= left && x < right && y >= top && y < bottom) {
+                        view.slots[view.visible_count++] = static_cast<u16>(slot);
+                    }
+                }
+            }
+        }
+
+        return view.visible_count;
+    }
+
+    std::size_t SpatialGrid::queryRadius(
+        const EntityStore& store, const float x, const float y, const float radius, EntityView& view) const
+    {
+        // the bounding square's right and bottom edges are exclusive; nudge them so the circle's edge stays in
+        const float reach = std::max(radius, 0.0f);
+        queryRect(store, x - reach, y - reach, std::nextafter(x + reach, INFINITE), std::nextafter(y + reach, INFINITE), view);
+
+        const float* world_x = store.worldX();
+        const float* world_y = store.worldY();
+        const float reach_sq = reach * reach;
+
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < view.visible_count; i++) {
+            const u16 slot = view.slots[i];
+            const float dx = world_x[slot] - x;
+            const float dy = world_y[slot] - y;
+            if (dx * dx + dy * dy <= reach_sq) {
+                view.slots[kept++] = slot;
+            }
+        }
+
+        view.visible_count = kept;
+        return kept;
+    }
+
+    std::size_t SpatialGrid::cellOf(const float world_x, const float world_y) const noexcept {
+        return cellRow(world_y) * m_columns + cellColumn(world_x);
+    }
+
+    // positions off the map fall into the nearest edge cell, so queries reaching past the map still see them.
+    // clamped to non-negative first, so truncation is the floor
+    std::size_t SpatialGrid::cellColumn(const float world_x) const noexcept {
+        return static_cast<std::size_t>(std::clamp(world_x * m_inverse_cell_size, 0.0f, static_cast<float>(m_columns - 1)));
+    }
+
+    std::size_t SpatialGrid::cellRow(const float world_y) const noexcept {
+        return static_cast<std::size_t>(std::clamp(world_y * m_inverse_cell_size, 0.0f, static_cast<float>(m_rows - 1)));
+    }
+
+    void SpatialGrid::link(const EntityId id, const std::size_t cell) noexcept {
+        const EntityId head = m_heads[cell];
+        m_next[id] = head;
+        m_prev[id] = INVALID_ENTITY_ID;
+        if (head != INVALID_ENTITY_ID) {
+            m_prev[head] = id;
+        }
+
+        m_heads[cell] = id;
+        m_cell[id] = static_cast<u32>(cell);
+    }
+
+    void SpatialGrid::unlink(const EntityId id) noexcept {
+        const EntityId next = m_next[id];
+        const EntityId prev = m_prev[id];
+        if (prev != INVALID_ENTITY_ID) {
+            m_next[prev] = next;
+        } else {
+            m_heads[m_cell[id]] = next;
+        }
+
+        if (next != INVALID_ENTITY_ID) {
+            m_prev[next] = prev;
+        }
+
+        m_next[id] = INVALID_ENTITY_ID;
+        m_prev[id] = INVALID_ENTITY_ID;
+        m_cell[id] = NO_CELL;
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef ENTITY_GRID_HXX_INCLUDED
+#define ENTITY_GRID_HXX_INCLUDED
+
+#include "amb_types.hxx"
+#include "entity_store.hxx"
+
+#include <cstddef>
+#include <vector>
+
+namespace amb::entity {
+    // derived index view over an EntityStore: `slots` only grows, and only [0, visible_count) is rewritten
+    // by each query
+    struct EntityView {
+        std::vector<u16> slots;
+        std::size_t visible_count = 0;
+    };
+
+    // uniform grid of square cells `cell_tiles` map tiles wide, so cell edges line up with MapRuntime tile
+    // edges. each cell keeps an intrusive list keyed by stable entity id, so moving between cells is O(1) and
+    // queries only visit the cells they overlap.
+    // cells are found by scaling world pixels with a cached 1 / (cell_tiles * MAP_TILE_SIZE) rather than through
+    // MapRuntime::worldToTileX/Y: those divide on every call and return INDEX_NPOS off the map, while binning
+    // runs for every entity each update and clamps off-map positions into the edge cells. queries use the
+    // same scaling, so they always agree with the binning
+    class SpatialGrid {
+    public:
+        // drops every entity and sizes the grid for a `map_width` x `map_height` tile map
+        void reset(std::size_t map_width, std::size_t map_height, std::size_t cell_tiles);
+        void clear() noexcept;
+
+        // bins new entities and moves those that crossed a cell boundary since the last call
+        void update(const EntityStore& store);
+        // call alongside EntityStore::remove; ids the store no longer knows are skipped by queries either way
+        void remove(EntityId id) noexcept;
+
+        std::size_t columns() const noexcept { return m_columns; }
+        std::size_t rows() const noexcept { return m_rows; }
+
+        // entities with left <= x < right and top <= y < bottom; returns view.visible_count
+        std::size_t queryRect(
+            const EntityStore& store, float left, float top, float right, float bottom, EntityView& view) const;
+        // entities within `radius` world pixels of (x, y); returns view.visible_count
+        std::size_t queryRadius(const EntityStore& store, float x, float y, float radius, EntityView& view) const;
+
+    private:
+        std::size_t cellOf(float world_x, float world_y) const noexcept;
+        std::size_t cellColumn(float world_x) const noexcept;
+        std::size_t cellRow(float world_y) const noexcept;
+        void link(EntityId id, std::size_t cell) noexcept;
+        void unlink(EntityId id) noexcept;
+
+        std::size_t m_cell_tiles = 1;
+        float m_inverse_cell_size = 0.0f;  // cells per world pixel
+        std::size_t m_columns = 1;
+        std::size_t m_rows = 1;
+
+        std::vector<EntityId> m_heads;  // per cell, INVALID_ENTITY_ID when empty
+        // per entity id
+        std::vector<EntityId> m_next;
+        std::vector<EntityId> m_prev;
+        std::vector<u32> m_cell;
+    };
+}
+
+#endif
@@ -0,0 +1,181 @@
+#include "entity_store.hxx"
+
+#include "utility_profile.hxx"
+#include "utility_simd.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace amb::entity {
+    namespace {
+        constexpr float DEGREES_TO_RADIANS = 3.14159265358979f / 180.0f;
+
+        // 90 degree sectors centred on up, right, down and left
+        amb::runtime::FacingDirection facingBucket(float heading) noexcept {
+            constexpr amb::runtime::FacingDirection SECTORS[] = {
+                amb::runtime::FacingDirection::up,
+                amb::runtime::FacingDirection::right,
+                amb::runtime::FacingDirection::down,
+                amb::runtime::FacingDirection::left,
+            };
+
+            const float wrapped = std::fmod(std::fmod(heading, 360.0f) + 360.0f, 360.0f);
+            return SECTORS[static_cast<std::size_t>((wrapped + 45.0f) / 90.0f) % 4];
+        }
+
+        // the clamp range for one axis; an unbounded axis clamps to infinity, so the kernel never branches
+        void axisRange(float bounds, float& min_value, float& max_value) noexcept {
+            min_value = (bounds > 0.0f) ? 0.0f : -std::numeric_limits<float>::infinity();
+            max_value = (bounds > 0.0f) ? bounds : std::numeric_limits<float>::infinity();
+        }
+    }
+
+    void EntityStore::reserve(const std::size_t count) {
+        m_world_x.reserve(count);
+        m_world_y.reserve(count);
+        m_velocity_x.reserve(count);
+        m_velocity_y.reserve(count);
+        m_heading.reserve(count);
+        m_speed.reserve(count);
+        m_facing.reserve(count);
+        m_flags.reserve(count);
+        m_types.reserve(count);
+        m_ids.reserve(count);
+    }
+
+    void EntityStore::clear() noexcept {
+        m_world_x.clear();
+        m_world_y.clear();
+        m_velocity_x.clear();
+        m_velocity_y.clear();
+        m_heading.clear();
+        m_speed.clear();
+        m_facing.clear();
+        m_flags.clear();
+        m_types.clear();
+        m_ids.clear();
+        m_slots.clear();
+    }
+
+    std::size_t EntityStore::add(const EntitySpawn& spawn) {
+        if (spawn.id == INVALID_ENTITY_ID) {
+            throw std::runtime_error("Entity id " + std::to_string(spawn.id) + " is reserved.");
+        }
+
+        if (slotOf(spawn.id) != NO_SLOT) {
+            throw std::runtime_error("Entity id " + std::to_string(spawn.id) + " is used more than once.");
+        }
+
+        if (spawn.id >= m_slots.size()) {
+            m_slots.resize(static_cast<std::size_t>(spawn.id) + 1, INVALID_ENTITY_ID);
+        }
+
+        const std::size_t slot = m_ids.size();
+        m_slots[spawn.id] = static_cast<u16>(slot);
+
+        m_world_x.push_back(spawn.world_x);
+        m_world_y.push_back(spawn.world_y);
+        m_velocity_x.push_back(0.0f);
+        m_velocity_y.push_back(0.0f);
+        m_heading.push_back(spawn.heading);
+        m_speed.push_back(spawn.speed);
+        m_facing.push_back(facingBucket(spawn.heading));
+        m_flags.push_back(spawn.flags);
+        m_types.push_back(spawn.type);
+        m_ids.push_back(spawn.id);
+
+        refreshVelocity(slot);
+        return slot;
+    }
+
+    bool EntityStore::remove(const EntityId id) noexcept {
+        const std::size_t slot = slotOf(id);
+        if (slot == NO_SLOT) {
+            return false;
+        }
+
+        const std::size_t last = m_ids.size() - 1;
+        if (slot != last) {
+            m_world_x[slot] = m_world_x[last];
+            m_world_y[slot] = m_world_y[last];
+            m_velocity_x[slot] = m_velocity_x[last];
+            m_velocity_y[slot] = m_velocity_y[last];
+            m_heading[slot] = m_heading[last];
+            m_speed[slot] = m_speed[last];
+            m_facing[slot] = m_facing[last];
+            m_flags[slot] = m_flags[last];
+            m_types[slot] = m_types[last];
+            m_ids[slot] = m_ids[last];
+            m_slots[m_ids[slot]] = static_cast<u16>(slot);
+        }
+
+        m_world_x.pop_back();
+        m_world_y.pop_back();
+        m_velocity_x.pop_back();
+        m_velocity_y.pop_back();
+        m_heading.pop_back();
+        m_speed.pop_back();
+        m_facing.pop_back();
+        m_flags.pop_back();
+        m_types.pop_back();
+        m_ids.pop_back();
+        m_slots[id] = INVALID_ENTITY_ID;
+        return true;
+    }
+
+    void EntityStore::setHeading(const std::size_t slot, const float heading) noexcept {
+        m_heading[slot] = heading;
+        m_facing[slot] = facingBucket(heading);
+        refreshVelocity(slot);
+    }
+
+    void EntityStore::setSpeed(const std::size_t slot, const float speed) noexcept {
+        m_speed[slot] = speed;
+        refreshVelocity(slot);
+    }
+
+    void EntityStore::setFlags(const std::size_t slot, const u8 flags) noexcept {
+        m_flags[slot] = flags;
+        refreshVelocity(slot);
+    }
+
+    void EntityStore::setPosition(const std::size_t slot, const float world_x, const float world_y) noexcept {
+        m_world_x[slot] = world_x;
+        m_world_y[slot] = world_y;
+    }
+
+    void EntityStore::setBounds(const float world_w, const float world_h) noexcept {
+        m_bounds_w = std::max(world_w, 0.0f);
+        m_bounds_h = std::max(world_h, 0.0f);
+    }
+
+    void EntityStore::integrate(const float step_ms) noexcept {
+        AMB_PROFILE_SCOPE("entity motion");
+        float min_x = 0.0f;
+        float max_x = 0.0f;
+        float min_y = 0.0f;
+        float max_y = 0.0f;
+        axisRange(m_bounds_w, min_x, max_x);
+        axisRange(m_bounds_h, min_y, max_y);
+
+        amb::utility::addScaledClamped(m_world_x.data(), m_velocity_x.data(), m_world_x.size(), step_ms, min_x, max_x);
+        amb::utility::addScaledClamped(m_world_y.data(), m_velocity_y.data(), m_world_y.size(), step_ms, min_y, max_y);
+    }
+
+    void EntityStore::refreshVelocity(const std::size_t slot) noexcept {
+        if ((m_flags[slot] & ENTITY_FLAG_FROZEN) != 0) {
+            m_velocity_x[slot] = 0.0f;
+            m_velocity_y[slot] = 0.0f;
+            return;
+        }
+
+        // heading 0 points up (-y) and turns clockwise towards +x
+        const float radians = m_heading[slot] * DEGREES_TO_RADIANS;
+        const float per_ms = m_speed[slot] / 1000.0f;
+        m_velocity_x[slot] = std::sin(radians) * per_ms;
+        m_velocity_y[slot] = -std::cos(radians) * per_ms;
+    }
+}
@@ -0,0 +1,98 @@
+#ifndef ENTITY_STORE_HXX_INCLUDED
+#define ENTITY_STORE_HXX_INCLUDED
+
+#include "amb_types.hxx"
+#include "runtime_entity.hxx"
+
+#include <cstddef>
+#include <vector>
+
+namespace amb::entity {
+    using EntityId = u16;
+
+    constexpr EntityId INVALID_ENTITY_ID = 0xFFFF;
+    constexpr std::size_t MAX_ENTITIES = INVALID_ENTITY_ID;
+    constexpr std::size_t NO_SLOT = static_cast<std::size_t>(-1);
+
+    // keeps heading and speed but does not move
+    constexpr u8 ENTITY_FLAG_FROZEN = 1u << 0;
+
+    enum class EntityType : u8 {
+        player = 0,
+        npc = 1,
+    };
+
+    struct EntitySpawn {
+        EntityId id = 0;
+        EntityType type = EntityType::npc;
+        u8 flags = 0;
+        float world_x = 0.0f;
+        float world_y = 0.0f;
+        float heading = 0.0f;  // degrees, 0 = up, clockwise
+        float speed = 0.0f;    // world pixels per second
+    };
+
+    // scene-owned hot entity state, one array per field so the fixed-step kernels stream over exactly what
+    // they touch. slots are dense and move when an entity is removed; ids stay stable and map to slots
+    class EntityStore {
+    public:
+        void reserve(std::size_t count);
+        void clear() noexcept;
+
+        // throws on an invalid or duplicate id; returns the new slot
+        std::size_t add(const EntitySpawn& spawn);
+        // moves the last entity into the freed slot; false when `id` is absent
+        bool remove(EntityId id) noexcept;
+
+        std::size_t size() const noexcept { return m_ids.size(); }
+        bool empty() const noexcept { return m_ids.empty(); }
+        std::size_t slotOf(EntityId id) const noexcept {
+            return (id < m_slots.size() && m_slots[id] != INVALID_ENTITY_ID) ? m_slots[id] : NO_SLOT;
+        }
+
+        // cold path: recompute the cached velocity, and the facing bucket after a heading change
+        void setHeading(std::size_t slot, float heading) noexcept;
+        void setSpeed(std::size_t slot, float speed) noexcept;
+        void setFlags(std::size_t slot, u8 flags) noexcept;
+        void setPosition(std::size_t slot, float world_x, float world_y) noexcept;
+
+        // world size in pixels entities may not leave; zero disables the clamp on that axis
+        void setBounds(float world_w, float world_h) noexcept;
+        float boundsWidth() const noexcept { return m_bounds_w; }
+        float boundsHeight() const noexcept { return m_bounds_h; }
+
+        // advances every entity by one fixed step
+        void integrate(float step_ms) noexcept;
+
+        EntityId id(std::size_t slot) const noexcept { return m_ids[slot]; }
+        EntityType type(std::size_t slot) const noexcept { return m_types[slot]; }
+        u8 flags(std::size_t slot) const noexcept { return m_flags[slot]; }
+        float heading(std::size_t slot) const noexcept { return m_heading[slot]; }
+        float speed(std::size_t slot) const noexcept { return m_speed[slot]; }
+        amb::runtime::FacingDirection facing(std::size_t slot) const noexcept { return m_facing[slot]; }
+
+        // slot-indexed arrays for systems that stream over every entity
+        const float* worldX() const noexcept { return m_world_x.data(); }
+        const float* worldY() const noexcept { return m_world_y.data(); }
+
+    private:
+        void refreshVelocity(std::size_t slot) noexcept;
+
+        std::vector<float> m_world_x;
+        std::vector<float> m_world_y;
+        std::vector<float> m_velocity_x;  // world pixels per ms, zero while frozen
+        std::vector<float> m_velocity_y;
+        std::vector<float> m_heading;
+        std::vector<float> m_speed;
+        std::vector<amb::runtime::FacingDirection> m_facing;
+        std::vector<u8> m_flags;
+        std::vector<EntityType> m_types;
+        std::vector<EntityId> m_ids;  // slot -> id
+
+        std::vector<u16> m_slots;  // id -> slot, INVALID_ENTITY_ID when absent; grows to the largest id
+        float m_bounds_w = 0.0f;
+        float m_bounds_h = 0.0f;
+    };
+}
+
+#endif
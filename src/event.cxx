@@ -1,20 +1,66 @@
 #include <SDL3/SDL.h>
 #include "ambassador.hxx"
 
+namespace {
+    // input that can move what the next frame shows; stamps past the cap (a long pause) are dropped
+    const std::size_t MAX_PENDING_INPUT_STAMPS = 256;
+
+    bool affectsView(const u32 type) noexcept {
+        return type == SDL_EVENT_KEY_DOWN || type == SDL_EVENT_KEY_UP || type == SDL_EVENT_MOUSE_WHEEL
+            || type == SDL_EVENT_MOUSE_BUTTON_DOWN || type == SDL_EVENT_MOUSE_BUTTON_UP;
+    }
+}
+
 SDL_AppResult Ambassador::event(SDL_Event *event) {
+    AMB_PROFILE_SCOPE("event");
     if (event->type == SDL_EVENT_QUIT) {
         return SDL_APP_SUCCESS;
     }
 
+    // target textures lose their contents on these, so cached layers redraw from scratch
+    if (event->type == SDL_EVENT_RENDER_TARGETS_RESET || event->type == SDL_EVENT_RENDER_DEVICE_RESET) {
+        for (const auto& layer : m_layers) {
+            layer->invalidateRenderCache();
+        }
+    }
+
+    if (event->type == SDL_EVENT_WINDOW_EXPOSED || event->type == SDL_EVENT_WINDOW_RESIZED) {
+        markFrameDirty();
+    }
+
+    // SDL stamps events with SDL_GetTicksNS() time, the clock render() reads after presenting
+    if (affectsView(event->type) && m_input_pending_ns.size() < MAX_PENDING_INPUT_STAMPS) {
+        m_input_pending_ns.push_back(event->common.timestamp);
+    }
+
+    if (event->type == SDL_EVENT_MOUSE_WHEEL) {
+        m_pending_zoom_steps += event->wheel.y;
+    }
+
     if (event->type == SDL_EVENT_KEY_DOWN) {
         if (event->key.scancode == SDL_SCANCODE_ESCAPE) {
             return SDL_APP_SUCCESS;
         }
 
+        if (event->key.scancode == SDL_SCANCODE_EQUALS) {
+            m_pending_zoom_steps += 1.0f;
+        } else if (event->key.scancode == SDL_SCANCODE_MINUS) {
+            m_pending_zoom_steps -= 1.0f;
+        }
+
+        if (event->key.scancode == SDL_SCANCODE_F3 && !event->key.repeat) {
+            m_frame_graph.setVisible(!m_frame_graph.visible());
+            markFrameDirty();
+        } else if (event->key.scancode == SDL_SCANCODE_F4 && !event->key.repeat) {
+            dumpTrace();
+        }
+
         if (event->key.scancode == SDL_SCANCODE_BACKSLASH && !event->key.repeat) {
             m_running = !m_running;
             if (m_running) {
-                m_lasttick = SDL_GetTicks();
+                m_timestep.reset(SDL_GetTicksNS());
+                // the pause is not latency
+                m_input_pending_ns.clear();
             }
         }
     }
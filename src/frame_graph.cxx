@@ -0,0 +1,114 @@
+#include "frame_graph.hxx"
+#include "config.hxx"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    const float GRAPH_MARGIN = 16.0f;
+    const float GRAPH_HEIGHT = 160.0f;
+    const float BAR_WIDTH = 2.0f;
+    const double GRAPH_SCALE_MS = 1000.0 / 30.0;  // full graph height
+
+    struct PhaseStyle {
+        const char* scope;
+        SDL_Color color;
+    };
+
+    // indexed by FrameGraphOverlay::Phase; the last entry has no scope of its own
+    const PhaseStyle PHASE_STYLES[] = {
+        {"event", SDL_Color {80, 140, 255, 255}},
+        {"update", SDL_Color {90, 210, 110, 255}},
+        {"render", SDL_Color {255, 170, 60, 255}},
+        {"present", SDL_Color {200, 110, 230, 255}},
+        {nullptr, SDL_Color {150, 150, 150, 255}},
+    };
+}
+
+void FrameGraphOverlay::collect() {
+    m_events.clear();
+    amb::utility::profile::readThreadEvents(m_cursor, m_events);
+
+    for (const amb::utility::profile::Event& event : m_events) {
+        if (event.name == nullptr) {
+            continue;
+        }
+
+        const u64 duration_ns = event.end_ns - event.start_ns;
+        if (std::strcmp(event.name, "frame") == 0) {
+            const u64 tracked_ns = m_pending.phase_ns[PHASE_UPDATE] + m_pending.phase_ns[PHASE_RENDER]
+                + m_pending.phase_ns[PHASE_PRESENT];
+            m_pending.phase_ns[PHASE_OTHER] = (duration_ns > tracked_ns) ? duration_ns - tracked_ns : 0;
+
+            m_history[m_next] = m_pending;
+            m_next = (m_next + 1) % HISTORY;
+            m_count = std::min(m_count + 1, HISTORY);
+            m_pending = {};
+            continue;
+        }
+
+        for (std::size_t phase = 0; phase < PHASE_OTHER; phase++) {
+            if (std::strcmp(event.name, PHASE_STYLES[phase].scope) == 0) {
+                m_pending.phase_ns[phase] += duration_ns;
+                break;
+            }
+        }
+    }
+}
+
+void FrameGraphOverlay::render(SDL_Renderer* renderer) const {
+    if (!m_visible || renderer == nullptr) {
+        return;
+    }
+
+    SDL_BlendMode previous_blend = SDL_BLENDMODE_NONE;
+    u8 previous_r = 0;
+    u8 previous_g = 0;
+    u8 previous_b = 0;
+    u8 previous_a = 0;
+    SDL_GetRenderDrawBlendMode(renderer, &previous_blend);
+    SDL_GetRenderDrawColor(renderer, &previous_r, &previous_g, &previous_b, &previous_a);
+
+    const float left = GRAPH_MARGIN;
+    const float bottom = static_cast<float>(amb::config::DEFAULT_APP_HEIGHT) - GRAPH_MARGIN;
+    const float width = static_cast<float>(HISTORY) * BAR_WIDTH;
+    const float pixels_per_ns = GRAPH_HEIGHT / static_cast<float>(GRAPH_SCALE_MS * 1'000'000.0);
+
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 160);
+    const SDL_FRect background {left, bottom - GRAPH_HEIGHT, width, GRAPH_HEIGHT};
+    SDL_RenderFillRect(renderer, &background);
+
+    // one FillRects call per phase; bars run oldest to newest, left to right
+    for (std::size_t phase = 0; phase < PHASE_COUNT; phase++) {
+        std::size_t bar_count = 0;
+        for (std::size_t i = 0; i < m_count; i++) {
+            const FrameSample& sample = m_history[(m_next + HISTORY - m_count + i) % HISTORY];
+
+            u64 below_ns = 0;
+            for (std::size_t lower = 0; lower < phase; lower++) {
+                below_ns += sample.phase_ns[lower];
+            }
+
+            const float y0 = std::max(bottom - static_cast<float>(below_ns) * pixels_per_ns, bottom - GRAPH_HEIGHT);
+            const float y1 = std::max(y0 - static_cast<float>(sample.phase_ns[phase]) * pixels_per_ns, bottom - GRAPH_HEIGHT);
+            if (y1 < y0) {
+                m_bars[bar_count++] = SDL_FRect {left + static_cast<float>(i) * BAR_WIDTH, y1, BAR_WIDTH, y0 - y1};
+            }
+        }
+
+        const SDL_Color& color = PHASE_STYLES[phase].color;
+        SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
+        SDL_RenderFillRects(renderer, m_bars.data(), static_cast<int>(bar_count));
+    }
+
+    // budget lines: one fixed update step and a 60 Hz frame
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 110);
+    for (const double budget_ms : {static_cast<double>(amb::config::UPDATE_STEP_NS) / 1'000'000.0, 1000.0 / 60.0}) {
+        const float y = bottom - static_cast<float>(budget_ms / GRAPH_SCALE_MS) * GRAPH_HEIGHT;
+        SDL_RenderLine(renderer, left, y, left + width, y);
+    }
+
+    SDL_SetRenderDrawBlendMode(renderer, previous_blend);
+    SDL_SetRenderDrawColor(renderer, previous_r, previous_g, previous_b, previous_a);
+}
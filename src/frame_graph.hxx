@@ -0,0 +1,52 @@
+#ifndef FRAME_GRAPH_HXX_INCLUDED
+#define FRAME_GRAPH_HXX_INCLUDED
+
+#include "amb_types.hxx"
+#include "utility_profile.hxx"
+
+#include <SDL3/SDL.h>
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+// on-screen frame-time graph built from the main thread's profiler events: one stacked bar per frame,
+// split into the "event", "update", "render" and "present" scopes; drawn over the layers like a layer
+class FrameGraphOverlay {
+public:
+    // folds the main thread's events recorded since the last call into the history; a "frame" event closes a bar
+    void collect();
+    void render(SDL_Renderer* renderer) const;
+
+    void setVisible(bool visible) noexcept { m_visible = visible; }
+    bool visible() const noexcept { return m_visible; }
+
+private:
+    enum Phase : std::size_t {
+        PHASE_EVENT,
+        PHASE_UPDATE,
+        PHASE_RENDER,
+        PHASE_PRESENT,
+        PHASE_OTHER,  // rest of the frame scope
+        PHASE_COUNT,
+    };
+
+    static constexpr std::size_t HISTORY = 240;
+
+    struct FrameSample {
+        u64 phase_ns[PHASE_COUNT] {};
+    };
+
+    bool m_visible = false;
+    u64 m_cursor = 0;
+    std::vector<amb::utility::profile::Event> m_events;
+
+    std::array<FrameSample, HISTORY> m_history {};
+    std::size_t m_next = 0;   // slot the next finished frame goes to
+    std::size_t m_count = 0;
+    FrameSample m_pending {};
+
+    mutable std::array<SDL_FRect, HISTORY> m_bars {};  // render() scratch, one phase at a time
+};
+
+#endif
@@ -1,19 +1,121 @@
 #include <SDL3/SDL.h>
 #include "ambassador.hxx"
 
+#include <algorithm>
+#include <cmath>
+
 SDL_AppResult Ambassador::loop() {
+    AMB_PROFILE_SCOPE("frame");
+    // layers keep streaming in while the window presents frames
+    if (pumpPreloader() != SDL_APP_CONTINUE) {
+        return SDL_APP_FAILURE;
+    }
+
     if (!m_running) {
+        waitForWork();
         return SDL_APP_CONTINUE;
     }
 
-    u64 now = SDL_GetTicks();
-    if (needUpdate(now)) {
-        update(now);
+    const u64 frame_start_ns = SDL_GetTicksNS();
+    const u32 steps = m_timestep.advance(frame_start_ns);
+    for (u32 i = 0; i < steps; i++) {
+        update();
+    }
+
+    const u64 render_start_ns = SDL_GetTicksNS();
+    m_timestep.recordUpdate(render_start_ns - frame_start_ns);
+
+    const float alpha = m_timestep.alpha();
+    if (!frameDirty(alpha)) {
+        waitForWork();
+        return SDL_APP_CONTINUE;
+    }
+
+    m_frame_graph.collect();
+    const SDL_AppResult result = render(alpha);
+    m_timestep.recordRender(SDL_GetTicksNS() - render_start_ns);
+    return result;
+}
+
+// the frame would differ from the one on screen; the frame graph redraws every frame while shown
+bool Ambassador::frameDirty(const float alpha) const {
+    if (!amb::config::RENDER_ON_DEMAND || m_frame_dirty || m_frame_graph.visible() || !m_input_applied_ns.empty()) {
+        return true;
+    }
+
+    if (!(Camera::interpolate(m_previous_camera, m_camera, alpha) == m_rendered_camera)) {
+        return true;
+    }
+
+    return std::any_of(m_layers.begin(), m_layers.end(), [](const VisualLayerPtr& layer) {
+        return layer->contentDirty();
+    });
+}
+
+// sleeps until input arrives or the next update step is due; paused, only input wakes the loop.
+// the event stays queued, SDL hands it to event() before the next iteration
+void Ambassador::waitForWork() {
+    if (!amb::config::RENDER_ON_DEMAND || m_preloader.active()) {
+        return;
     }
 
-    return render();
+    AMB_PROFILE_SCOPE("idle");
+    const u64 timeout_ns = m_timestep.untilNextStepNs();
+    SDL_WaitEventTimeout(nullptr, m_running ? static_cast<Sint32>((timeout_ns + 999'999) / 1'000'000) : -1);
 }
 
-void Ambassador::update(u64 now) {
-    m_lasttick = now;
+void Ambassador::update() {
+    AMB_PROFILE_SCOPE("update");
+    m_previous_camera = m_camera;
+    updateCamera();
+
+    // input consumed by this tick shows up in the next presented frame
+    m_input_applied_ns.insert(m_input_applied_ns.end(), m_input_pending_ns.begin(), m_input_pending_ns.end());
+    m_input_pending_ns.clear();
+
+    // whole milliseconds from the step count, so 8.33 ms steps do not drift
+    m_update_count++;
+    const u64 update_time_ms = m_update_count * amb::config::UPDATE_STEP_NS / 1'000'000;
+    const u32 elapsed_ms = static_cast<u32>(update_time_ms - m_update_time_ms);
+    m_update_time_ms = update_time_ms;
+
+    for (VisualLayerPtr& layer : m_layers) {
+        layer->animate(elapsed_ms);
+    }
+
+    // entities are not drawn yet, so moving them does not dirty the frame
+    m_entities.integrate(static_cast<float>(amb::config::UPDATE_STEP_NS) / 1'000'000.0f);
+    m_entity_grid.update(m_entities);
+
+    const float half_w = m_camera.viewportWidth() * 0.5f / m_camera.zoom();
+    const float half_h = m_camera.viewportHeight() * 0.5f / m_camera.zoom();
+    m_entity_grid.queryRect(
+        m_entities,
+        m_camera.x() - half_w,
+        m_camera.y() - half_h,
+        m_camera.x() + half_w,
+        m_camera.y() + half_h,
+        m_visible_entities);
+}
+
+// arrows/WASD scroll at a fixed screen speed per tick, so zoomed-out views cover more world
+void Ambassador::updateCamera() {
+    const bool* keys = SDL_GetKeyboardState(nullptr);
+    float direction_x = 0.0f;
+    float direction_y = 0.0f;
+
+    if (keys != nullptr) {
+        direction_x = static_cast<float>(keys[SDL_SCANCODE_RIGHT] || keys[SDL_SCANCODE_D])
+            - static_cast<float>(keys[SDL_SCANCODE_LEFT] || keys[SDL_SCANCODE_A]);
+        direction_y = static_cast<float>(keys[SDL_SCANCODE_DOWN] || keys[SDL_SCANCODE_S])
+            - static_cast<float>(keys[SDL_SCANCODE_UP] || keys[SDL_SCANCODE_W]);
+    }
+
+    if (m_pending_zoom_steps != 0.0f) {
+        m_camera.setZoom(m_camera.zoom() * std::pow(amb::config::CAMERA_ZOOM_STEP, m_pending_zoom_steps));
+        m_pending_zoom_steps = 0.0f;
+    }
+
+    const float step = amb::config::CAMERA_SCROLL_SPEED * static_cast<float>(amb::config::UPDATE_STEP_NS) / 1e9f;
+    m_camera.move(direction_x * step / m_camera.zoom(), direction_y * step / m_camera.zoom());
 }
@@ -7,12 +7,27 @@ SDL_AppResult SDL_AppInit(void **appstate, int argc, char **argv) {
     Ambassador *app = new Ambassador();
     *appstate = app;
 
+    // the benchmark runs to completion here and never opens a window
+    if (argc >= 2 && SDL_strcmp(argv[1], "--bench") == 0) {
+        RenderBenchOptions options;
+        if (!parseRenderBenchOptions(argc, argv, options)) {
+            SDL_Log("Usage: ambassador --bench <sandbox.damb> [--frames <n>] [--warmup <n>] [--no-cache]");
+            return SDL_APP_FAILURE;
+        }
+
+        if (app->bootstrapHeadless() != SDL_APP_CONTINUE) {
+            return SDL_APP_FAILURE;
+        }
+
+        return (app->runRenderBench(options) == SDL_APP_CONTINUE) ? SDL_APP_SUCCESS : SDL_APP_FAILURE;
+    }
+
     if (app->bootstrap() != SDL_APP_CONTINUE) {
         return SDL_APP_FAILURE;
     }
 
     if (argc < 2) {
-        SDL_Log("Usage: ambassador <sandbox.damb>");
+        SDL_Log("Usage: ambassador <sandbox.damb> | ambassador --bench <sandbox.damb> [options]");
         return SDL_APP_FAILURE;
     }
 
@@ -1,35 +1,80 @@
 #include <SDL3/SDL.h>
 #include "ambassador.hxx"
 
-SDL_AppResult Ambassador::render() {
-    if (!SDL_SetRenderDrawColor(
-        renderer(),
-        (u8)0,
-        (u8)0,
-        (u8)0,
-        SDL_ALPHA_OPAQUE
-    )) {
-        SDL_Log("Renderer failed: %s", SDL_GetError());
-        return SDL_APP_FAILURE;
-    }
-
-    if (!SDL_RenderClear(renderer())) {
-        SDL_Log("Renderer clear failed: %s", SDL_GetError());
-        return SDL_APP_FAILURE;
-    }
+SDL_AppResult Ambassador::render(const float alpha) {
+    {
+        AMB_PROFILE_SCOPE("render");
+        if (!SDL_SetRenderDrawColor(
+            renderer(),
+            (u8)0,
+            (u8)0,
+            (u8)0,
+            SDL_ALPHA_OPAQUE
+        )) {
+            SDL_Log("Renderer failed: %s", SDL_GetError());
+            return SDL_APP_FAILURE;
+        }
 
-    for (const auto& layer : m_layers) {
-        const SDL_Rect viewport = layerViewportFor(*layer);
-        if (!SDL_SetRenderViewport(renderer(), &viewport)) {
-            SDL_Log("Renderer viewport setup failed: %s", SDL_GetError());
+        if (!SDL_RenderClear(renderer())) {
+            SDL_Log("Renderer clear failed: %s", SDL_GetError());
             return SDL_APP_FAILURE;
         }
 
-        layer->render(renderer());
+        m_frame_render_stats = {};
+        const Camera camera = Camera::interpolate(m_previous_camera, m_camera, alpha);
+
+        for (const auto& layer : m_layers) {
+            const SDL_Rect viewport = layerViewportFor(*layer);
+            if (!SDL_SetRenderViewport(renderer(), &viewport)) {
+                SDL_Log("Renderer viewport setup failed: %s", SDL_GetError());
+                return SDL_APP_FAILURE;
+            }
+
+            layer->setView(camera.viewFor(viewport.w, viewport.h, layer->parallax()));
+            layer->render(renderer());
+            m_frame_render_stats.draw_calls += layer->renderStats().draw_calls;
+            m_frame_render_stats.tiles_drawn += layer->renderStats().tiles_drawn;
+            layer->clearContentDirty();
+        }
+
+        m_rendered_camera = camera;
+        m_frame_dirty = false;
+
+        SDL_SetRenderViewport(renderer(), nullptr);
+        m_frame_graph.render(renderer());
     }
 
-    SDL_SetRenderViewport(renderer(), nullptr);
-    SDL_RenderPresent(renderer());
+    {
+        AMB_PROFILE_SCOPE("present");
+        SDL_RenderPresent(renderer());
+    }
 
+    recordInputLatency(SDL_GetTicksNS());
     return SDL_APP_CONTINUE;
 }
+
+void Ambassador::recordInputLatency(const u64 present_ns) {
+    for (const u64 stamp_ns : m_input_applied_ns) {
+        m_input_latency.add((present_ns > stamp_ns) ? present_ns - stamp_ns : 0);
+    }
+    m_input_applied_ns.clear();
+
+    if (m_input_latency_window_ns == 0) {
+        m_input_latency_window_ns = present_ns;
+    }
+    if (present_ns - m_input_latency_window_ns < amb::config::INPUT_LATENCY_LOG_INTERVAL_NS) {
+        return;
+    }
+
+    if (m_input_latency.count() > 0) {
+        SDL_Log("Input to present: %llu events, p50 %.1f ms, p95 %.1f ms, p99 %.1f ms, max %.1f ms",
+            static_cast<unsigned long long>(m_input_latency.count()),
+            static_cast<double>(m_input_latency.percentileNs(50.0)) / 1e6,
+            static_cast<double>(m_input_latency.percentileNs(95.0)) / 1e6,
+            static_cast<double>(m_input_latency.percentileNs(99.0)) / 1e6,
+            static_cast<double>(m_input_latency.maxNs()) / 1e6);
+    }
+    m_last_input_latency = m_input_latency;
+    m_input_latency.reset();
+    m_input_latency_window_ns = present_ns;
+}
@@ -0,0 +1,192 @@
+#include "render_bench.hxx"
+#include "ambassador.hxx"
+#include "utility_histogram.hxx"
+#include "utility_parse.hxx"
+
+#include <SDL3/SDL.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace {
+    const float PI = 3.14159265f;
+
+    // the path runs through three phases; each row of the report covers one of them
+    enum BenchPhase : std::size_t {
+        PHASE_PAN,       // slow figure eight at zoom 1: mostly sub-tile scrolling
+        PHASE_ZOOM,      // zoom sweep between 0.5 and 2 around the map center
+        PHASE_FAST_PAN,  // straight run zoomed out: many newly exposed tiles per frame
+        PHASE_COUNT,
+    };
+
+    const char* const PHASE_NAMES[PHASE_COUNT] = {"pan", "zoom", "fast pan"};
+
+    struct CameraPose {
+        float x = 0.0f;
+        float y = 0.0f;
+        float zoom = 1.0f;
+        BenchPhase phase = PHASE_PAN;
+    };
+
+    struct PhaseSamples {
+        std::vector<double> frame_ms;
+        u64 draw_calls = 0;
+        u64 tiles_drawn = 0;
+        u32 max_tiles = 0;
+    };
+
+    // `t` in [0, 1) over the measured frames; positions are world pixels inside `world_w` x `world_h`
+    CameraPose benchPose(float t, float world_w, float world_h) {
+        if (t < 0.6f) {
+            const float u = t / 0.6f;
+            return CameraPose {
+                world_w * (0.5f + 0.35f * std::sin(2.0f * PI * u)),
+                world_h * (0.5f + 0.35f * std::sin(4.0f * PI * u)),
+                1.0f,
+                PHASE_PAN,
+            };
+        }
+
+        if (t < 0.8f) {
+            const float u = (t - 0.6f) / 0.2f;
+            return CameraPose {world_w * 0.5f, world_h * 0.5f, std::pow(2.0f, std::sin(4.0f * PI * u)), PHASE_ZOOM};
+        }
+
+        const float u = (t - 0.8f) / 0.2f;
+        return CameraPose {world_w * (0.15f + 0.7f * u), world_h * 0.5f, 0.5f, PHASE_FAST_PAN};
+    }
+
+    void printRow(std::ostream& out, const char* name, const PhaseSamples& samples) {
+        std::vector<double> sorted = samples.frame_ms;
+        std::sort(sorted.begin(), sorted.end());
+        if (sorted.empty()) {
+            return;
+        }
+
+        const double frames = static_cast<double>(sorted.size());
+        out << std::left << std::setw(10) << name << std::right
+            << std::setw(8) << sorted.size()
+            << std::setprecision(3)
+            << std::setw(10) << amb::utility::sortedPercentile(sorted, 50.0)
+            << std::setw(10) << amb::utility::sortedPercentile(sorted, 90.0)
+            << std::setw(10) << amb::utility::sortedPercentile(sorted, 99.0)
+            << std::setw(10) << sorted.back()
+            << std::setprecision(1)
+            << std::setw(12) << static_cast<double>(samples.draw_calls) / frames
+            << std::setw(12) << static_cast<double>(samples.tiles_drawn) / frames
+            << std::setw(12) << samples.max_tiles << '\n';
+    }
+}
+
+bool parseRenderBenchOptions(int argc, char** argv, RenderBenchOptions& options) {
+    if (argc < 3) {
+        SDL_Log("--bench expects a .damb file");
+        return false;
+    }
+
+    options.damb_path = argv[2];
+    for (int i = 3; i < argc; i++) {
+        const std::string option = argv[i];
+        if (option == "--no-cache") {
+            options.render_cache = false;
+            continue;
+        }
+
+        if (i + 1 >= argc) {
+            SDL_Log("%s expects a value", option.c_str());
+            return false;
+        }
+
+        try {
+            if (option == "--frames") {
+                options.frames = std::max<u32>(amb::utility::parseCount(argv[++i], option), 1);
+            } else if (option == "--warmup") {
+                options.warmup = amb::utility::parseCount(argv[++i], option);
+            } else {
+                SDL_Log("Unknown bench option: %s", option.c_str());
+                return false;
+            }
+        } catch (const std::exception& ex) {
+            SDL_Log("%s", ex.what());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+SDL_AppResult Ambassador::runRenderBench(const RenderBenchOptions& options) {
+    try {
+        m_layers = m_loader.loadMapLayers(renderer(), options.damb_path);
+    } catch (const std::exception& ex) {
+        SDL_Log("Failed to load DAMB file %s: %s", options.damb_path.string().c_str(), ex.what());
+        return SDL_APP_FAILURE;
+    }
+
+    arrangeLayers(true);
+    fitCameraToLayers();
+    for (const VisualLayerPtr& layer : m_layers) {
+        if (auto* map_layer = dynamic_cast<MapLayer*>(layer.get())) {
+            map_layer->setRenderCacheEnabled(options.render_cache);
+        }
+    }
+
+    PhaseSamples phases[PHASE_COUNT];
+    PhaseSamples total;
+    const u32 frame_count = options.warmup + options.frames;
+
+    for (u32 frame = 0; frame < frame_count; frame++) {
+        // warmup frames replay the start of the path so caches are primed where measuring begins
+        const u32 path_frame = (frame < options.warmup) ? 0 : frame - options.warmup;
+        const CameraPose pose = benchPose(
+            static_cast<float>(path_frame) / static_cast<float>(options.frames),
+            m_camera.boundsWidth(),
+            m_camera.boundsHeight());
+
+        update();
+        m_camera.setZoom(pose.zoom);
+        m_camera.setPosition(pose.x, pose.y);
+        m_previous_camera = m_camera;
+
+        const u64 start_ns = SDL_GetTicksNS();
+        if (render(0.0f) != SDL_APP_CONTINUE) {
+            return SDL_APP_FAILURE;
+        }
+        const double frame_ms = static_cast<double>(SDL_GetTicksNS() - start_ns) / 1'000'000.0;
+
+        if (frame < options.warmup) {
+            continue;
+        }
+
+        for (PhaseSamples* samples : {&phases[pose.phase], &total}) {
+            samples->frame_ms.push_back(frame_ms);
+            samples->draw_calls += m_frame_render_stats.draw_calls;
+            samples->tiles_drawn += m_frame_render_stats.tiles_drawn;
+            samples->max_tiles = std::max(samples->max_tiles, m_frame_render_stats.tiles_drawn);
+        }
+    }
+
+    std::cout << options.damb_path.string() << ": " << m_layers.size() << " layers, "
+              << options.frames << " frames (" << options.warmup << " warmup), "
+              << amb::config::DEFAULT_APP_WIDTH << "x" << amb::config::DEFAULT_APP_HEIGHT
+              << ", render cache " << (options.render_cache ? "on" : "off") << '\n';
+    std::cout << std::left << std::setw(10) << "phase" << std::right
+              << std::setw(8) << "frames"
+              << std::setw(10) << "p50 ms" << std::setw(10) << "p90 ms"
+              << std::setw(10) << "p99 ms" << std::setw(10) << "max ms"
+              << std::setw(12) << "draws/frm" << std::setw(12) << "tiles/frm" << std::setw(12) << "max tiles" << '\n';
+
+    std::cout << std::fixed;
+    for (std::size_t phase = 0; phase < PHASE_COUNT; phase++) {
+        printRow(std::cout, PHASE_NAMES[phase], phases[phase]);
+    }
+    printRow(std::cout, "total", total);
+    return SDL_APP_CONTINUE;
+}
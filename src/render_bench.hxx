@@ -0,0 +1,19 @@
+#ifndef RENDER_BENCH_HXX_INCLUDED
+#define RENDER_BENCH_HXX_INCLUDED
+
+#include "amb_types.hxx"
+
+#include <filesystem>
+
+// `ambassador --bench <file.damb> [--frames <n>] [--warmup <n>] [--no-cache]`
+struct RenderBenchOptions {
+    std::filesystem::path damb_path;
+    u32 frames = 600;
+    u32 warmup = 30;
+    bool render_cache = true;
+};
+
+// parses argv starting at `--bench`; logs the problem and returns false on bad input
+bool parseRenderBenchOptions(int argc, char** argv, RenderBenchOptions& options);
+
+#endif
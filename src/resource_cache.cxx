@@ -0,0 +1,123 @@
+#include "resource_cache.hxx"
+
+#include <utility>
+
+ImageRuntimePtr ResourceCache::findImage(const ResourceKey& key) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return find(m_images, key);
+}
+
+AtlasRuntimePtr ResourceCache::findAtlas(const ResourceKey& key) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return find(m_atlases, key);
+}
+
+ImageRuntimePtr ResourceCache::insertImage(const ResourceKey& key, ImageRuntime runtime, const std::size_t gpu_bytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return insert(m_images, Kind::image, key, std::move(runtime), gpu_bytes, m_gpu_bytes);
+}
+
+AtlasRuntimePtr ResourceCache::insertAtlas(const ResourceKey& key, AtlasRuntime runtime, const std::size_t cpu_bytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return insert(m_atlases, Kind::atlas, key, std::move(runtime), cpu_bytes, m_cpu_bytes);
+}
+
+template <typename T>
+std::shared_ptr<const T> ResourceCache::find(std::map<ResourceKey, Entry<T>>& entries, const ResourceKey& key) {
+    const auto it = entries.find(key);
+    if (it == entries.end()) {
+        return nullptr;
+    }
+
+    m_lru.splice(m_lru.end(), m_lru, it->second.lru);
+    return it->second.runtime;
+}
+
+template <typename T>
+std::shared_ptr<const T> ResourceCache::insert(
+    std::map<ResourceKey, Entry<T>>& entries,
+    const Kind kind,
+    const ResourceKey& key,
+    T runtime,
+    const std::size_t bytes,
+    std::size_t& usage)
+{
+    if (std::shared_ptr<const T> existing = find(entries, key)) {
+        return existing;
+    }
+
+    Entry<T> entry;
+    entry.runtime = std::make_shared<const T>(std::move(runtime));
+    entry.bytes = bytes;
+    entry.lru = m_lru.insert(m_lru.end(), LruNode { kind, key });
+
+    std::shared_ptr<const T> handle = entry.runtime;
+    entries.emplace(key, std::move(entry));
+    usage += bytes;
+
+    // the new entry is referenced by `handle`, so it never evicts itself. only its own category is trimmed:
+    // atlases are inserted from preload workers, and evicting an image there would destroy its texture off
+    // the main thread
+    trimLocked(kind == Kind::image, kind == Kind::atlas);
+    return handle;
+}
+
+void ResourceCache::trim() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    trimLocked(true, true);
+}
+
+void ResourceCache::trimLocked(const bool images, const bool atlases) {
+    for (auto node = m_lru.begin(); node != m_lru.end();) {
+        if ((!images || m_gpu_bytes <= m_budget.gpu_bytes) && (!atlases || m_cpu_bytes <= m_budget.cpu_bytes)) {
+            return;
+        }
+        if (!(node->kind == Kind::image ? images : atlases)) {
+            node = std::next(node);
+            continue;
+        }
+
+        const auto evict = [&](auto& entries, std::size_t& usage, const std::size_t budget) {
+            const auto it = entries.find(node->key);
+            if (usage <= budget || it->second.runtime.use_count() > 1) {
+                return false;
+            }
+
+            usage -= it->second.bytes;
+            entries.erase(it);
+            return true;
+        };
+
+        const bool evicted = (node->kind == Kind::image)
+            ? evict(m_images, m_gpu_bytes, m_budget.gpu_bytes)
+            : evict(m_atlases, m_cpu_bytes, m_budget.cpu_bytes);
+
+        node = evicted ? m_lru.erase(node) : std::next(node);
+    }
+}
+
+ResourceCache::Budget ResourceCache::budget() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_budget;
+}
+
+void ResourceCache::setBudget(const Budget budget) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_budget = budget;
+    trimLocked(true, true);
+}
+
+std::size_t ResourceCache::gpuBytes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_gpu_bytes;
+}
+
+std::size_t ResourceCache::cpuBytes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_cpu_bytes;
+}
+
+std::size_t ResourceCache::size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_images.size() + m_atlases.size();
+}
@@ -0,0 +1,103 @@
+#ifndef RESOURCE_CACHE_HXX_INCLUDED
+#define RESOURCE_CACHE_HXX_INCLUDED
+
+#include "runtime_atlas.hxx"
+#include "runtime_image.hxx"
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+// identifies one chunk across every file loaded this session
+struct ResourceKey {
+    std::string file;
+    u16 id = 0;
+
+    bool operator<(const ResourceKey& other) const noexcept {
+        return std::tie(file, id) < std::tie(other.file, other.id);
+    }
+};
+
+// shared IMAG textures and ATLS rect tables; entries no layer references any more are kept
+// for reuse and evicted least-recently-used first once their category exceeds its budget.
+// evicting an image destroys its texture, so only insertImage, trim and setBudget may evict images and
+// they must run on the main thread; insertAtlas evicts atlases only and is safe from preload workers
+class ResourceCache {
+public:
+    struct Budget {
+        std::size_t gpu_bytes = 0;
+        std::size_t cpu_bytes = 0;
+    };
+
+    explicit ResourceCache(Budget budget)
+    : m_budget(budget) {}
+
+    ResourceCache(const ResourceCache&) = delete;
+    ResourceCache& operator=(const ResourceCache&) = delete;
+
+    // nullptr on a miss; a hit marks the entry as most recently used
+    ImageRuntimePtr findImage(const ResourceKey& key);
+    AtlasRuntimePtr findAtlas(const ResourceKey& key);
+
+    // when another thread inserted the same key first, its entry is returned and `runtime` is dropped
+    ImageRuntimePtr insertImage(const ResourceKey& key, ImageRuntime runtime, std::size_t gpu_bytes);
+    AtlasRuntimePtr insertAtlas(const ResourceKey& key, AtlasRuntime runtime, std::size_t cpu_bytes);
+
+    // evicts unreferenced entries until both categories fit their budget (or nothing else can go)
+    void trim();
+
+    Budget budget() const;
+    void setBudget(Budget budget);
+
+    std::size_t gpuBytes() const;
+    std::size_t cpuBytes() const;
+    std::size_t size() const;
+
+private:
+    enum class Kind : u8 {
+        image,
+        atlas,
+    };
+
+    struct LruNode {
+        Kind kind = Kind::image;
+        ResourceKey key;
+    };
+
+    template <typename T>
+    struct Entry {
+        std::shared_ptr<const T> runtime;
+        std::size_t bytes = 0;
+        std::list<LruNode>::iterator lru;
+    };
+
+    template <typename T>
+    std::shared_ptr<const T> find(std::map<ResourceKey, Entry<T>>& entries, const ResourceKey& key);
+
+    template <typename T>
+    std::shared_ptr<const T> insert(
+        std::map<ResourceKey, Entry<T>>& entries,
+        Kind kind,
+        const ResourceKey& key,
+        T runtime,
+        std::size_t bytes,
+        std::size_t& usage);
+
+    // evicts from the selected categories only
+    void trimLocked(bool images, bool atlases);
+
+    mutable std::mutex m_mutex;
+    Budget m_budget;
+
+    std::map<ResourceKey, Entry<ImageRuntime>> m_images;
+    std::map<ResourceKey, Entry<AtlasRuntime>> m_atlases;
+    std::list<LruNode> m_lru;  // front is least recently used
+
+    std::size_t m_gpu_bytes = 0;
+    std::size_t m_cpu_bytes = 0;
+};
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef RUNTIME_ANIMATION_HXX_INCLUDED
+#define RUNTIME_ANIMATION_HXX_INCLUDED
+
+#include "amb_types.hxx"
+#include "runtime_atlas.hxx"
+
+#include <cstddef>
+#include <numeric>
+#include <vector>
+
+// advances an atlas's tile animations and exposes the result as an atlas index indirection table;
+// cells are never rewritten, renderers look up remap(cell) instead. each step costs O(animations)
+class TileAnimator {
+public:
+    // identity mapping for every rect, with every animation on its first frame; `atlas` must outlive the animator
+    void reset(const AtlasRuntime& atlas) {
+        m_animations = &atlas.animations;
+        m_remap.resize(atlas.rects.size());
+        std::iota(m_remap.begin(), m_remap.end(), Cell {0});
+        m_animated.assign(atlas.rects.size(), 0);
+        m_states.assign(atlas.animations.size(), State {});
+
+        for (const TileAnimation& animation : atlas.animations) {
+            m_remap[animation.atlas_index] = animation.frames.front().atlas_index;
+            m_animated[animation.atlas_index] = 1;
+        }
+
+        m_version++;
+    }
+
+    // returns true when any animation moved to another frame
+    bool advance(u32 elapsed_ms) noexcept {
+        if (m_animations == nullptr || m_states.empty()) {
+            return false;
+        }
+
+        bool changed = false;
+        for (std::size_t i = 0; i < m_states.size(); i++) {
+            const TileAnimation& animation = (*m_animations)[i];
+            State& state = m_states[i];
+
+            // whole cycles change nothing, so a long step costs at most one pass over the frames
+            u64 remaining = static_cast<u64>(state.elapsed_ms) + elapsed_ms % animation.cycle_ms;
+            u32 frame = state.frame;
+            while (remaining >= animation.frames[frame].duration_ms) {
+                remaining -= animation.frames[frame].duration_ms;
+                frame = (frame + 1) % static_cast<u32>(animation.frames.size());
+            }
+            state.elapsed_ms = static_cast<u32>(remaining);
+
+            if (frame != state.frame) {
+                state.frame = frame;
+                m_remap[animation.atlas_index] = animation.frames[frame].atlas_index;
+                changed = true;
+            }
+        }
+
+        if (changed) {
+            m_version++;
+        }
+
+        return changed;
+    }
+
+    Cell remap(Cell cell) const noexcept {
+        return (static_cast<std::size_t>(cell) < m_remap.size()) ? m_remap[cell] : cell;
+    }
+
+    bool animated(Cell cell) const noexcept {
+        return static_cast<std::size_t>(cell) < m_animated.size() && m_animated[cell] != 0;
+    }
+
+    bool empty() const noexcept { return m_states.empty(); }
+
+    // bumped whenever remap() changes, so renderers can tell whether their animated tiles are stale
+    u64 version() const noexcept { return m_version; }
+
+private:
+    struct State {
+        u32 frame = 0;
+        u32 elapsed_ms = 0;  // time spent on `frame`
+    };
+
+    const std::vector<TileAnimation>* m_animations = nullptr;
+    std::vector<Cell> m_remap;
+    std::vector<u8> m_animated;
+    std::vector<State> m_states;
+    u64 m_version = 0;
+};
+
+#endif
@@ -1,17 +1,39 @@
 #ifndef RUNTIME_ATLAS_HXX_INCLUDED
 #define RUNTIME_ATLAS_HXX_INCLUDED
 
+#include "amb_types.hxx"
+#include "runtime_mask.hxx"
 #include "runtime_object.hxx"
 
+#include <memory>
 #include <vector>
 
 #include <SDL3/SDL.h>
 
+struct TileAnimationFrame {
+    u16 atlas_index = 0;
+    u32 duration_ms = 0;
+};
+
+// cells holding `atlas_index` show `frames` in turn; `cycle_ms` is the sum of the frame durations
+struct TileAnimation {
+    u16 atlas_index = 0;
+    u32 cycle_ms = 0;
+    std::vector<TileAnimationFrame> frames;
+};
+
 class AtlasRuntime final : public RuntimeObject {
 public:
     std::vector<SDL_FRect> rects;
+    std::vector<u8> opaque;  // per rect, 1 when ATLS_RECORD_FLAG_OPAQUE is set (for animated rects: on every frame)
+    std::vector<u8> solid;   // per rect, 1 when ATLS_RECORD_FLAG_SOLID is set
+    std::vector<TileAnimation> animations;  // from the ANIM chunk sharing the atlas id, if any
+    PixelMaskSet masks;  // from the MASK chunk sharing the atlas id, if any
+    u16 image_id = 0;  // IMAG chunk the rects index into
 
     const char* typeName() const noexcept override { return "AtlasRuntime"; }
 };
 
+using AtlasRuntimePtr = std::shared_ptr<const AtlasRuntime>;
+
 #endif
@@ -0,0 +1,124 @@
+#ifndef RUNTIME_CAMERA_HXX_INCLUDED
+#define RUNTIME_CAMERA_HXX_INCLUDED
+
+#include "amb_types.hxx"
+
+#include <algorithm>
+#include <cmath>
+
+namespace amb::runtime {
+    const float CAMERA_MIN_ZOOM = 0.25f;
+    const float CAMERA_MAX_ZOOM = 4.0f;
+
+    // what one layer sees this frame: the world pixel at the viewport's top-left corner and the scale
+    struct CameraView {
+        float world_x = 0.0f;
+        float world_y = 0.0f;
+        float zoom = 1.0f;
+
+        bool operator==(const CameraView& other) const noexcept {
+            return world_x == other.world_x && world_y == other.world_y && zoom == other.zoom;
+        }
+    };
+}
+
+// world-space camera; the update tick moves it, the render pass turns it into one view per layer
+class Camera {
+public:
+    float x() const noexcept { return m_x; }
+    float y() const noexcept { return m_y; }
+    float zoom() const noexcept { return m_zoom; }
+    float boundsWidth() const noexcept { return m_bounds_w; }
+    float boundsHeight() const noexcept { return m_bounds_h; }
+    float viewportWidth() const noexcept { return m_viewport_w; }
+    float viewportHeight() const noexcept { return m_viewport_h; }
+
+    // centers the camera on a world position
+    void setPosition(float world_x, float world_y) noexcept {
+        m_x = world_x;
+        m_y = world_y;
+        clampToBounds();
+    }
+
+    void move(float delta_x, float delta_y) noexcept {
+        setPosition(m_x + delta_x, m_y + delta_y);
+    }
+
+    void setZoom(float zoom) noexcept {
+        m_zoom = std::clamp(zoom, amb::runtime::CAMERA_MIN_ZOOM, amb::runtime::CAMERA_MAX_ZOOM);
+        clampToBounds();
+    }
+
+    // screen pixels covered by the view; needed to keep the view inside the bounds
+    void setViewportSize(int width, int height) noexcept {
+        m_viewport_w = static_cast<float>(std::max(width, 0));
+        m_viewport_h = static_cast<float>(std::max(height, 0));
+        clampToBounds();
+    }
+
+    // world size in pixels the view may not leave; an axis smaller than the view stays centered.
+    // zero disables clamping on that axis
+    void setBounds(float world_w, float world_h) noexcept {
+        m_bounds_w = std::max(world_w, 0.0f);
+        m_bounds_h = std::max(world_h, 0.0f);
+        clampToBounds();
+    }
+
+    // `parallax` scales camera movement for the layer (1 follows the camera, 0 stays fixed); the origin is
+    // snapped to whole screen pixels so tiles keep their position while the camera moves sub-pixel amounts
+    amb::runtime::CameraView viewFor(int viewport_w, int viewport_h, float parallax = 1.0f) const noexcept {
+        const float half_w = static_cast<float>(viewport_w) * 0.5f / m_zoom;
+        const float half_h = static_cast<float>(viewport_h) * 0.5f / m_zoom;
+
+        return amb::runtime::CameraView {
+            std::round((m_x * parallax - half_w) * m_zoom) / m_zoom,
+            std::round((m_y * parallax - half_h) * m_zoom) / m_zoom,
+            m_zoom,
+        };
+    }
+
+    bool operator==(const Camera& other) const noexcept {
+        return m_x == other.m_x && m_y == other.m_y && m_zoom == other.m_zoom
+            && m_viewport_w == other.m_viewport_w && m_viewport_h == other.m_viewport_h
+            && m_bounds_w == other.m_bounds_w && m_bounds_h == other.m_bounds_h;
+    }
+
+    // the camera between two update states; `alpha` 0 is `from`, 1 is `to`
+    static Camera interpolate(const Camera& from, const Camera& to, float alpha) noexcept {
+        Camera camera = to;
+        camera.m_x = from.m_x + (to.m_x - from.m_x) * alpha;
+        camera.m_y = from.m_y + (to.m_y - from.m_y) * alpha;
+        camera.m_zoom = from.m_zoom + (to.m_zoom - from.m_zoom) * alpha;
+        return camera;
+    }
+
+private:
+    void clampToBounds() noexcept {
+        m_x = clampAxis(m_x, m_bounds_w, m_viewport_w);
+        m_y = clampAxis(m_y, m_bounds_h, m_viewport_h);
+    }
+
+    float clampAxis(float center, float bounds, float viewport) const noexcept {
+        if (bounds <= 0.0f) {
+            return center;
+        }
+
+        const float half_view = viewport * 0.5f / m_zoom;
+        if (half_view * 2.0f >= bounds) {
+            return bounds * 0.5f;
+        }
+
+        return std::clamp(center, half_view, bounds - half_view);
+    }
+
+    float m_x = 0.0f;
+    float m_y = 0.0f;
+    float m_zoom = 1.0f;
+
+    float m_viewport_w = 0.0f;
+    float m_viewport_h = 0.0f;
+    float m_bounds_w = 0.0f;
+    float m_bounds_h = 0.0f;
+};
+
+#endif
@@ -0,0 +1,415 @@
+#include "runtime_collision.hxx"
+
+#include "config.hxx"
+#include "utility_profile.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+    namespace runtime = amb::runtime;
+
+    constexpr i64 NO_COLUMN = std::numeric_limits<i64>::min();
+    constexpr float INFINITE = std::numeric_limits<float>::infinity();
+
+    // float drift this small does not count as overlapping a tile, so a box resting exactly against a wall
+    // can still slide along it. a few ulps of the coordinate, since far from the origin one ulp alone is
+    // larger than any fixed epsilon
+    float contactSlack(const float world) noexcept {
+        return std::max(1.0f / 1024.0f, std::fabs(world) * (1.0f / 1048576.0f));
+    }
+
+    // world span [low, high) shrunk by the contact slack on both ends
+    float slackLow(const float low) noexcept { return low + contactSlack(low); }
+    float slackHigh(const float high) noexcept { return high - contactSlack(high); }
+
+    int lowestBit(const u64 bits) noexcept {
+#if defined(_MSC_VER)
+        unsigned long index = 0;
+        _BitScanForward64(&index, bits);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctzll(bits);
+#endif
+    }
+
+    int highestBit(const u64 bits) noexcept {
+#if defined(_MSC_VER)
+        unsigned long index = 0;
+        _BitScanReverse64(&index, bits);
+        return static_cast<int>(index);
+#else
+        return 63 - __builtin_clzll(bits);
+#endif
+    }
+
+    // bits first..last (inclusive) of a word
+    u64 bitRange(const int first, const int last) noexcept {
+        return (~u64 {0} << first) & (~u64 {0} >> (63 - last));
+    }
+
+    float tileSize() noexcept {
+        return static_cast<float>(amb::game::MAP_TILE_SIZE);
+    }
+
+    bool finite(const runtime::CollisionBox& box) noexcept {
+        return std::isfinite(box.x) && std::isfinite(box.y) && std::isfinite(box.w) && std::isfinite(box.h);
+    }
+}
+
+CollisionMap::CollisionMap(const std::size_t width, const std::size_t height)
+: m_width(width),
+  m_height(height),
+  m_words_per_row((width + 63) / 64),
+  m_words(m_words_per_row * height, 0) {}
+
+CollisionMap CollisionMap::build(const MapRuntime& map, const std::vector<u8>& solid_records) {
+    AMB_PROFILE_SCOPE("collision build");
+    CollisionMap collision(map.width(), map.height());
+    if (!map.validCellCount()) {
+        return collision;
+    }
+
+    // whole-map runs either start a row (row-major) or sit inside one aligned 16-cell span (bricked), so every
+    // 64-cell chunk lands in a single word
+    MapRuntime::CellRunIterator runs = map.cellRuns(0, 0, map.width() - 1, map.height() - 1);
+    for (runtime::CellRun run; runs.next(run);) {
+        u64* words = collision.m_words.data() + run.tile_y * collision.m_words_per_row;
+
+        for (std::size_t x = 0; x < run.count; x += 64) {
+            const std::size_t count = std::min<std::size_t>(64, run.count - x);
+            u64 bits = 0;
+            for (std::size_t i = 0; i < count; i++) {
+                const Cell cell = run.cells[x + i];
+                const u64 solid = (cell < solid_records.size() && solid_records[cell] != 0) ? 1u : 0u;
+                bits |= solid << i;
+            }
+            words[(run.tile_x + x) / 64] |= bits << ((run.tile_x + x) % 64);
+        }
+    }
+
+    return collision;
+}
+
+bool CollisionMap::solidAt(const float world_x, const float world_y) const noexcept {
+    if (!std::isfinite(world_x) || !std::isfinite(world_y)) {
+        return true;
+    }
+
+    return solidTile(floorTile(world_x), floorTile(world_y));
+}
+
+void CollisionMap::setSolid(const std::size_t tile_x, const std::size_t tile_y, const bool solid) noexcept {
+    if (tile_x >= m_width || tile_y >= m_height) {
+        return;
+    }
+
+    u64& word = m_words[tile_y * m_words_per_row + tile_x / 64];
+    const u64 bit = u64 {1} << (tile_x % 64);
+    word = solid ? (word | bit) : (word & ~bit);
+}
+
+bool CollisionMap::overlaps(const runtime::CollisionBox& box) const noexcept {
+    if (!finite(box)) {
+        return true;
+    }
+
+    const i64 first = floorTile(slackLow(box.x));
+    const i64 last = ceilTile(slackHigh(box.x + box.w)) - 1;
+    const i64 row_first = floorTile(slackLow(box.y));
+    const i64 row_last = ceilTile(slackHigh(box.y + box.h)) - 1;
+    return firstSolidColumn(row_first, row_last, first, last) != NO_COLUMN;
+}
+
+runtime::SweepResult CollisionMap::sweep(const runtime::CollisionBox& box, const float dx, const float dy) const noexcept {
+    runtime::SweepResult result {};
+    if (!finite(box) || !std::isfinite(dx) || !std::isfinite(dy)) {
+        result.hit_x = dx != 0.0f;
+        result.hit_y = dy != 0.0f;
+        return result;
+    }
+
+    result.dx = sweepX(box, dx, result.hit_x);
+
+    runtime::CollisionBox moved = box;
+    moved.x += result.dx;
+    result.dy = sweepY(moved, dy, result.hit_y);
+    return result;
+}
+
+runtime::RayHit CollisionMap::castRay(const runtime::Ray& ray) const noexcept {
+    runtime::RayHit result {};
+    const float length = std::sqrt(ray.direction_x * ray.direction_x + ray.direction_y * ray.direction_y);
+    if (!(length > 0.0f) || !std::isfinite(length) || !(ray.max_distance >= 0.0f)
+        || !std::isfinite(ray.origin_x) || !std::isfinite(ray.origin_y))
+    {
+        return result;
+    }
+
+    // everything below is in tile units, so stepping a row costs multiplies only
+    const float tile = tileSize();
+    const float origin_x = ray.origin_x / tile;
+    const float origin_y = ray.origin_y / tile;
+    const float max_t = ray.max_distance / tile;
+    const float ux = ray.direction_x / length;
+    const float uy = ray.direction_y / length;
+    const float inverse_uy = (uy != 0.0f) ? 1.0f / uy : 0.0f;
+    const float limit = tileLimit();
+    const auto floorTiles = [limit](const float tiles) { return static_cast<i64>(std::clamp(std::floor(tiles), -1.0f, limit)); };
+    const auto ceilTiles = [limit](const float tiles) { return static_cast<i64>(std::clamp(std::ceil(tiles), -1.0f, limit)); };
+
+    i64 row = floorTiles(origin_y);
+    i64 entry_column = floorTiles(origin_x);
+    if (solidTile(entry_column, row)) {
+        result.hit = true;
+        result.tile_x = entry_column;
+        result.tile_y = row;
+        return result;
+    }
+
+    // walks row by row; the columns the ray crosses inside one row are a single word-at-a-time scan
+    float row_enter = 0.0f;
+    for (;;) {
+        float row_exit = INFINITE;
+        if (uy > 0.0f) {
+            row_exit = (static_cast<float>(row + 1) - origin_y) * inverse_uy;
+        } else if (uy < 0.0f) {
+            row_exit = (static_cast<float>(row) - origin_y) * inverse_uy;
+        }
+
+        const float x_end = origin_x + ux * std::min(row_exit, max_t);
+        i64 exit_column = entry_column;
+        if (ux > 0.0f) {
+            exit_column = std::max(entry_column, ceilTiles(x_end) - 1);
+        } else if (ux < 0.0f) {
+            exit_column = std::min(entry_column, floorTiles(x_end));
+        }
+
+        const i64 column = (ux >= 0.0f)
+            ? firstSolidColumn(row, row, entry_column, exit_column)
+            : lastSolidColumn(row, row, exit_column, entry_column);
+
+        if (column != NO_COLUMN) {
+            float t = row_enter;
+            if (column == entry_column) {
+                // the origin tile is clear, so this is a later row entered through its top or bottom face
+                result.normal_y = (uy > 0.0f) ? -1 : 1;
+            } else {
+                const float face = (ux > 0.0f) ? static_cast<float>(column) : static_cast<float>(column + 1);
+                t = std::max((face - origin_x) / ux, row_enter);
+                result.normal_x = (ux > 0.0f) ? -1 : 1;
+            }
+
+            if (t > max_t) {
+                return runtime::RayHit {};
+            }
+
+            result.hit = true;
+            result.distance = std::min(t * tile, ray.max_distance);
+            result.tile_x = column;
+            result.tile_y = row;
+            return result;
+        }
+
+        if (row_exit >= max_t) {
+            return result;
+        }
+
+        row_enter = row_exit;
+        row += (uy > 0.0f) ? 1 : -1;
+
+        const float x_enter = origin_x + ux * row_enter;
+        if (ux > 0.0f) {
+            entry_column = std::max(exit_column, floorTiles(x_enter));
+        } else if (ux < 0.0f) {
+            entry_column = std::min(exit_column, ceilTiles(x_enter) - 1);
+        }
+    }
+}
+
+void CollisionMap::sweepBatch(
+    const runtime::SweepRequest* requests, runtime::SweepResult* results, const std::size_t count) const noexcept
+{
+    AMB_PROFILE_SCOPE("collision sweeps");
+    for (std::size_t i = 0; i < count; i++) {
+        results[i] = sweep(requests[i].box, requests[i].dx, requests[i].dy);
+    }
+}
+
+void CollisionMap::castRayBatch(const runtime::Ray* rays, runtime::RayHit* hits, const std::size_t count) const noexcept {
+    AMB_PROFILE_SCOPE("collision rays");
+    for (std::size_t i = 0; i < count; i++) {
+        hits[i] = castRay(rays[i]);
+    }
+}
+
+float CollisionMap::sweepX(const runtime::CollisionBox& box, const float dx, bool& hit) const noexcept {
+    hit = false;
+    if (dx == 0.0f) {
+        return 0.0f;
+    }
+
+    const i64 row_first = floorTile(slackLow(box.y));
+    const i64 row_last = ceilTile(slackHigh(box.y + box.h)) - 1;
+    const float tile = tileSize();
+
+    if (dx > 0.0f) {
+        // columns the right edge newly enters
+        const float edge = box.x + box.w;
+        const i64 first = ceilTile(slackHigh(edge));
+        const i64 last = ceilTile(edge + dx) - 1;
+        const i64 column = firstSolidColumn(row_first, row_last, first, last);
+        if (column == NO_COLUMN) {
+            return dx;
+        }
+
+        hit = true;
+        return std::clamp(static_cast<float>(column) * tile - edge, 0.0f, dx);
+    }
+
+    const float edge = box.x;
+    const i64 first = floorTile(edge + dx);
+    const i64 last = floorTile(slackLow(edge)) - 1;
+    const i64 column = lastSolidColumn(row_first, row_last, first, last);
+    if (column == NO_COLUMN) {
+        return dx;
+    }
+
+    hit = true;
+    return std::clamp(static_cast<float>(column + 1) * tile - edge, dx, 0.0f);
+}
+
+float CollisionMap::sweepY(const runtime::CollisionBox& box, const float dy, bool& hit) const noexcept {
+    hit = false;
+    if (dy == 0.0f) {
+        return 0.0f;
+    }
+
+    const i64 first_column = floorTile(slackLow(box.x));
+    const i64 last_column = ceilTile(slackHigh(box.x + box.w)) - 1;
+    const float tile = tileSize();
+
+    if (dy > 0.0f) {
+        const float edge = box.y + box.h;
+        const i64 last = ceilTile(edge + dy) - 1;
+        for (i64 row = ceilTile(slackHigh(edge)); row <= last; row++) {
+            if (rowBlocked(row, first_column, last_column)) {
+                hit = true;
+                return std::clamp(static_cast<float>(row) * tile - edge, 0.0f, dy);
+            }
+        }
+
+        return dy;
+    }
+
+    const float edge = box.y;
+    const i64 first = floorTile(edge + dy);
+    for (i64 row = floorTile(slackLow(edge)) - 1; row >= first; row--) {
+        if (rowBlocked(row, first_column, last_column)) {
+            hit = true;
+            return std::clamp(static_cast<float>(row + 1) * tile - edge, dy, 0.0f);
+        }
+    }
+
+    return dy;
+}
+
+i64 CollisionMap::firstSolidColumn(const i64 row_first, const i64 row_last, const i64 first, const i64 last) const noexcept {
+    if (last < first || row_last < row_first) {
+        return NO_COLUMN;
+    }
+
+    if (row_first < 0 || row_last >= static_cast<i64>(m_height) || first < 0) {
+        return first;
+    }
+
+    const i64 width = static_cast<i64>(m_width);
+    if (first < width) {
+        const i64 scan_last = std::min(last, width - 1);
+        for (i64 word = first / 64; word <= scan_last / 64; word++) {
+            u64 bits = 0;
+            for (i64 row = row_first; row <= row_last; row++) {
+                bits |= m_words[static_cast<std::size_t>(row) * m_words_per_row + static_cast<std::size_t>(word)];
+            }
+
+            const int low = (word == first / 64) ? static_cast<int>(first % 64) : 0;
+            const int high = (word == scan_last / 64) ? static_cast<int>(scan_last % 64) : 63;
+            bits &= bitRange(low, high);
+            if (bits != 0) {
+                return word * 64 + lowestBit(bits);
+            }
+        }
+    }
+
+    return (last >= width) ? std::max(first, width) : NO_COLUMN;
+}
+
+i64 CollisionMap::lastSolidColumn(const i64 row_first, const i64 row_last, const i64 first, const i64 last) const noexcept {
+    if (last < first || row_last < row_first) {
+        return NO_COLUMN;
+    }
+
+    const i64 width = static_cast<i64>(m_width);
+    if (row_first < 0 || row_last >= static_cast<i64>(m_height) || last >= width) {
+        return last;
+    }
+
+    if (last >= 0) {
+        const i64 scan_first = std::max<i64>(first, 0);
+        for (i64 word = last / 64; word >= scan_first / 64; word--) {
+            u64 bits = 0;
+            for (i64 row = row_first; row <= row_last; row++) {
+                bits |= m_words[static_cast<std::size_t>(row) * m_words_per_row + static_cast<std::size_t>(word)];
+            }
+
+            const int low = (word == scan_first / 64) ? static_cast<int>(scan_first % 64) : 0;
+            const int high = (word == last / 64) ? static_cast<int>(last % 64) : 63;
+            bits &= bitRange(low, high);
+            if (bits != 0) {
+                return word * 64 + highestBit(bits);
+            }
+        }
+    }
+
+    return (first < 0) ? std::min<i64>(last, -1) : NO_COLUMN;
+}
+
+bool CollisionMap::rowBlocked(const i64 row, const i64 first, const i64 last) const noexcept {
+    if (last < first) {
+        return false;
+    }
+
+    if (row < 0 || row >= static_cast<i64>(m_height) || first < 0 || last >= static_cast<i64>(m_width)) {
+        return true;
+    }
+
+    const u64* words = m_words.data() + static_cast<std::size_t>(row) * m_words_per_row;
+    for (i64 word = first / 64; word <= last / 64; word++) {
+        const int low = (word == first / 64) ? static_cast<int>(first % 64) : 0;
+        const int high = (word == last / 64) ? static_cast<int>(last % 64) : 63;
+        if ((words[word] & bitRange(low, high)) != 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// tile coordinates are clamped just past the map on both sides, which keeps huge or infinite
+// positions representable while everything beyond the edge stays solid
+i64 CollisionMap::floorTile(const float world) const noexcept {
+    return static_cast<i64>(std::clamp(std::floor(world / tileSize()), -1.0f, tileLimit()));
+}
+
+i64 CollisionMap::ceilTile(const float world) const noexcept {
+    return static_cast<i64>(std::clamp(std::ceil(world / tileSize()), -1.0f, tileLimit()));
+}
+
+float CollisionMap::tileLimit() const noexcept {
+    return static_cast<float>(std::max(m_width, m_height) + 1);
+}
@@ -0,0 +1,111 @@
+#ifndef RUNTIME_COLLISION_HXX_INCLUDED
+#define RUNTIME_COLLISION_HXX_INCLUDED
+
+#include "amb_types.hxx"
+#include "runtime_map.hxx"
+
+#include <cstddef>
+#include <vector>
+
+namespace amb::runtime {
+    // axis-aligned box in world pixels; (x, y) is the top-left corner
+    struct CollisionBox {
+        float x = 0.0f;
+        float y = 0.0f;
+        float w = 0.0f;
+        float h = 0.0f;
+    };
+
+    struct SweepRequest {
+        CollisionBox box;
+        float dx = 0.0f;
+        float dy = 0.0f;
+    };
+
+    // how far the box may move before touching a solid tile; hit_x / hit_y tell which axis was cut short
+    struct SweepResult {
+        float dx = 0.0f;
+        float dy = 0.0f;
+        bool hit_x = false;
+        bool hit_y = false;
+    };
+
+    struct Ray {
+        float origin_x = 0.0f;
+        float origin_y = 0.0f;
+        float direction_x = 0.0f;  // need not be normalized
+        float direction_y = 0.0f;
+        float max_distance = 0.0f;  // world pixels
+    };
+
+    // `normal` is the face the ray entered through; zero when the ray starts inside a solid tile
+    struct RayHit {
+        bool hit = false;
+        float distance = 0.0f;
+        i64 tile_x = 0;
+        i64 tile_y = 0;
+        i8 normal_x = 0;
+        i8 normal_y = 0;
+    };
+}
+
+// one bit per map cell, set for cells whose atlas record is solid. rows are padded to whole u64 words so
+// sweeps and rays test up to 64 cells per load. everything outside the map counts as solid
+class CollisionMap {
+public:
+    CollisionMap() = default;
+    CollisionMap(std::size_t width, std::size_t height);
+
+    // sets the bit of every cell whose atlas record index has a non-zero entry in `solid_records`;
+    // animated cells collide as their stored record, whatever frame is showing
+    static CollisionMap build(const MapRuntime& map, const std::vector<u8>& solid_records);
+
+    std::size_t width() const noexcept { return m_width; }
+    std::size_t height() const noexcept { return m_height; }
+    std::size_t wordsPerRow() const noexcept { return m_words_per_row; }
+    const std::vector<u64>& words() const noexcept { return m_words; }
+
+    bool solidTile(i64 tile_x, i64 tile_y) const noexcept {
+        if (tile_x < 0 || tile_y < 0 || static_cast<u64>(tile_x) >= m_width || static_cast<u64>(tile_y) >= m_height) {
+            return true;
+        }
+
+        const u64 word = m_words[static_cast<std::size_t>(tile_y) * m_words_per_row + static_cast<std::size_t>(tile_x) / 64];
+        return ((word >> (tile_x % 64)) & 1u) != 0;
+    }
+
+    bool solidAt(float world_x, float world_y) const noexcept;
+    void setSolid(std::size_t tile_x, std::size_t tile_y, bool solid) noexcept;
+
+    // true when the box overlaps any solid tile
+    bool overlaps(const amb::runtime::CollisionBox& box) const noexcept;
+
+    // moves along x, then along y from where x stopped. only tiles the box newly enters block it,
+    // so a box that starts overlapping a wall can still back out
+    amb::runtime::SweepResult sweep(const amb::runtime::CollisionBox& box, float dx, float dy) const noexcept;
+    amb::runtime::RayHit castRay(const amb::runtime::Ray& ray) const noexcept;
+
+    // one tick's worth of queries, e.g. every projectile; `results` / `hits` hold `count` entries
+    void sweepBatch(const amb::runtime::SweepRequest* requests, amb::runtime::SweepResult* results, std::size_t count) const noexcept;
+    void castRayBatch(const amb::runtime::Ray* rays, amb::runtime::RayHit* hits, std::size_t count) const noexcept;
+
+private:
+    float sweepX(const amb::runtime::CollisionBox& box, float dx, bool& hit) const noexcept;
+    float sweepY(const amb::runtime::CollisionBox& box, float dy, bool& hit) const noexcept;
+
+    // first / last solid column in [first, last] over rows [row_first, row_last]; NO_COLUMN when none
+    i64 firstSolidColumn(i64 row_first, i64 row_last, i64 first, i64 last) const noexcept;
+    i64 lastSolidColumn(i64 row_first, i64 row_last, i64 first, i64 last) const noexcept;
+    bool rowBlocked(i64 row, i64 first, i64 last) const noexcept;
+
+    i64 floorTile(float world) const noexcept;
+    i64 ceilTile(float world) const noexcept;
+    float tileLimit() const noexcept;
+
+    std::size_t m_width = 0;
+    std::size_t m_height = 0;
+    std::size_t m_words_per_row = 0;
+    std::vector<u64> m_words;
+};
+
+#endif
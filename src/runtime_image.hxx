@@ -4,6 +4,8 @@
 #include "amb_types.hxx"
 #include "runtime_object.hxx"
 
+#include <memory>
+
 class ImageRuntime final : public RuntimeObject {
 public:
     TexturePtr texture;
@@ -11,4 +13,7 @@ public:
     const char* typeName() const noexcept override { return "ImageRuntime"; }
 };
 
+// images are shared between layers through the ResourceCache
+using ImageRuntimePtr = std::shared_ptr<const ImageRuntime>;
+
 #endif
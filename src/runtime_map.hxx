@@ -4,9 +4,11 @@
 #include "amb_types.hxx"
 #include "config.hxx"
 
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
 #include <limits>
+#include <utility>
 #include <vector>
 
 namespace amb::runtime {
@@ -19,25 +21,158 @@ namespace amb::runtime {
         float world_y = 0.0f;
         bool is_fallback = true;
     };
+
+    // how MapRuntime orders its cells in memory; the tile API is the same either way
+    enum class CellLayout : u8 {
+        row_major,
+        // MAP_BRICK_TILES square bricks stored one after another in row-major brick order, row-major inside
+        // each brick, so a small region touches a few contiguous blocks instead of one stride per row
+        bricked,
+    };
+
+    constexpr std::size_t MAP_BRICK_SHIFT = 4;
+    constexpr std::size_t MAP_BRICK_TILES = std::size_t {1} << MAP_BRICK_SHIFT;  // 16x16 cells, 512 bytes
+    constexpr std::size_t MAP_BRICK_MASK = MAP_BRICK_TILES - 1;
+
+    // cells of one tile row that are adjacent in storage: tiles [tile_x, tile_x + count) of row tile_y
+    struct CellRun {
+        std::size_t tile_x = 0;
+        std::size_t tile_y = 0;
+        const Cell* cells = nullptr;
+        std::size_t count = 0;
+    };
 }
 
 class MapRuntime {
 public:
+    // walks a tile region one CellRun at a time: whole region rows for row-major maps, brick rows for bricked
+    // maps, finishing each brick before the next so a scan streams through storage in order
+    class CellRunIterator {
+    public:
+        CellRunIterator() = default;
+
+        bool next(amb::runtime::CellRun& run) noexcept {
+            if (m_map == nullptr) {
+                return false;
+            }
+
+            const bool bricked = m_map->m_layout == amb::runtime::CellLayout::bricked;
+            const size_t left = bricked ? std::max(m_min_tx, m_brick_x << amb::runtime::MAP_BRICK_SHIFT) : m_min_tx;
+            const size_t right = bricked ? std::min(m_max_tx, (m_brick_x << amb::runtime::MAP_BRICK_SHIFT) | amb::runtime::MAP_BRICK_MASK) : m_max_tx;
+            run.tile_x = left;
+            run.tile_y = m_tile_y;
+            run.cells = m_map->m_cells.data() + m_map->indexOfTile(left, m_tile_y);
+            run.count = right - left + 1;
+
+            if (!bricked) {
+                if (++m_tile_y > m_max_ty) {
+                    m_map = nullptr;
+                }
+                return true;
+            }
+
+            // down the current brick, then across the brick row, then to the next brick row
+            const size_t brick_top = (m_tile_y >> amb::runtime::MAP_BRICK_SHIFT) << amb::runtime::MAP_BRICK_SHIFT;
+            if (m_tile_y < std::min(m_max_ty, brick_top | amb::runtime::MAP_BRICK_MASK)) {
+                m_tile_y++;
+            } else if (((m_brick_x + 1) << amb::runtime::MAP_BRICK_SHIFT) <= m_max_tx) {
+                m_brick_x++;
+                m_tile_y = std::max(m_min_ty, brick_top);
+            } else if (brick_top + amb::runtime::MAP_BRICK_TILES <= m_max_ty) {
+                m_brick_x = m_min_tx >> amb::runtime::MAP_BRICK_SHIFT;
+                m_tile_y = brick_top + amb::runtime::MAP_BRICK_TILES;
+            } else {
+                m_map = nullptr;
+            }
+            return true;
+        }
+
+    private:
+        friend class MapRuntime;
+
+        const MapRuntime* m_map = nullptr;
+        size_t m_min_tx = 0;
+        size_t m_max_tx = 0;
+        size_t m_min_ty = 0;
+        size_t m_max_ty = 0;
+        size_t m_brick_x = 0;
+        size_t m_tile_y = 0;
+    };
+
     MapRuntime(size_t width, size_t height)
     : m_width(width), m_height(height) {}
 
+    // adopts a fully decoded row-major cell array
+    MapRuntime(size_t width, size_t height, std::vector<Cell> cells)
+    : m_width(width), m_height(height), m_cells(std::move(cells)) {}
+
     inline size_t width() const noexcept { return m_width; }
     inline size_t height() const noexcept { return m_height; }
 
+    // bricked maps store whole bricks, so cellCount() includes the padding past the right and bottom edges
     inline size_t cellCount() const noexcept { return m_cells.size(); }
-    inline bool validCellCount() const noexcept { return m_width * m_height == m_cells.size(); }
+    inline bool validCellCount() const noexcept { return storageCellCount(m_layout) == m_cells.size(); }
 
+    // storage order is layout(); go through indexOfTile / cellRuns rather than assuming rows
     inline const std::vector<Cell>& cells() const noexcept { return m_cells; }
 
     inline void reserveCells(std::size_t count) { m_cells.reserve(count); }
 
+    // row-major maps only
     inline void appendCell(Cell cell) { m_cells.push_back(cell); }
 
+    inline amb::runtime::CellLayout layout() const noexcept { return m_layout; }
+
+    // reorders the cells in place; a map without a full set of cells only records the new layout
+    inline void setLayout(amb::runtime::CellLayout layout) {
+        if (layout == m_layout) {
+            return;
+        }
+
+        if (!validCellCount()) {
+            m_layout = layout;
+            return;
+        }
+
+        MapRuntime reordered(m_width, m_height);
+        reordered.m_layout = layout;
+        reordered.m_cells.assign(reordered.storageCellCount(layout), 0);
+
+        CellRunIterator runs = cellRuns(0, 0, m_width - 1, m_height - 1);
+        for (amb::runtime::CellRun run; runs.next(run);) {
+            for (size_t i = 0; i < run.count; i++) {
+                reordered.m_cells[reordered.indexOfTile(run.tile_x + i, run.tile_y)] = run.cells[i];
+            }
+        }
+
+        m_cells = std::move(reordered.m_cells);
+        m_layout = layout;
+    }
+
+    // runs covering tiles [min_tx, max_tx] x [min_ty, max_ty], clamped to the map; yields nothing when the
+    // region is empty or off the map
+    inline CellRunIterator cellRuns(size_t min_tx, size_t min_ty, size_t max_tx, size_t max_ty) const noexcept {
+        CellRunIterator runs;
+        if (!validCellCount() || m_width == 0 || m_height == 0) {
+            return runs;
+        }
+
+        max_tx = std::min(max_tx, m_width - 1);
+        max_ty = std::min(max_ty, m_height - 1);
+        if (min_tx > max_tx || min_ty > max_ty) {
+            return runs;
+        }
+
+        runs.m_map = this;
+        runs.m_min_tx = min_tx;
+        runs.m_max_tx = max_tx;
+        runs.m_min_ty = min_ty;
+        runs.m_max_ty = max_ty;
+        runs.m_brick_x = min_tx >> amb::runtime::MAP_BRICK_SHIFT;
+        runs.m_tile_y = min_ty;
+        return runs;
+    }
+
     inline Cell* tryCell(float world_x, float world_y) noexcept {
         const size_t idx = indexOf(world_x, world_y);
         return (idx == amb::runtime::INDEX_NPOS || idx >= m_cells.size()) ? nullptr : &m_cells[idx];
@@ -138,7 +273,14 @@ public:
             return amb::runtime::INDEX_NPOS;
         }
 
-        return (tile_y * m_width) + tile_x;
+        if (m_layout == amb::runtime::CellLayout::row_major) {
+            return (tile_y * m_width) + tile_x;
+        }
+
+        const size_t brick = (tile_y >> amb::runtime::MAP_BRICK_SHIFT) * m_brick_columns + (tile_x >> amb::runtime::MAP_BRICK_SHIFT);
+        return (brick << (2 * amb::runtime::MAP_BRICK_SHIFT))
+            + ((tile_y & amb::runtime::MAP_BRICK_MASK) << amb::runtime::MAP_BRICK_SHIFT)
+            + (tile_x & amb::runtime::MAP_BRICK_MASK);
     }
 
     inline amb::runtime::SpawnPoint defaultSpawnPoint() const noexcept {
@@ -158,8 +300,19 @@ public:
     }
 
 private:
+    inline size_t storageCellCount(amb::runtime::CellLayout layout) const noexcept {
+        if (layout == amb::runtime::CellLayout::row_major) {
+            return m_width * m_height;
+        }
+
+        const size_t brick_rows = (m_height + amb::runtime::MAP_BRICK_MASK) >> amb::runtime::MAP_BRICK_SHIFT;
+        return (m_brick_columns * brick_rows) << (2 * amb::runtime::MAP_BRICK_SHIFT);
+    }
+
     size_t m_width;
     size_t m_height;
+    size_t m_brick_columns = (m_width + amb::runtime::MAP_BRICK_MASK) >> amb::runtime::MAP_BRICK_SHIFT;
+    amb::runtime::CellLayout m_layout = amb::runtime::CellLayout::row_major;
     std::vector<Cell> m_cells;
 };
 
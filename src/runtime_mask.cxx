@@ -0,0 +1,70 @@
+#include "runtime_mask.hxx"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+    // the 64 bits of `row` starting at bit `start`; bits before the row start or past its end read as 0.
+    // callers keep start > -64
+    u64 rowBits(const u64* row, const i64 word_count, const i64 start) noexcept {
+        if (start < 0) {
+            return row[0] << static_cast<u32>(-start);
+        }
+
+        const i64 index = start / 64;
+        const u32 shift = static_cast<u32>(start % 64);
+        const u64 low = (index < word_count) ? row[index] >> shift : 0;
+        const u64 high = (shift != 0 && index + 1 < word_count) ? row[index + 1] << (64 - shift) : 0;
+        return low | high;
+    }
+}
+
+bool PixelMask::overlaps(const PixelMask& other, const i32 offset_x, const i32 offset_y) const noexcept {
+    if (empty() || other.empty()) {
+        return false;
+    }
+
+    // the overlap rectangle in this mask's pixels
+    const i64 column_first = std::max<i64>(offset_x, 0);
+    const i64 column_end = std::min<i64>(static_cast<i64>(offset_x) + other.width, width);
+    const i64 row_first = std::max<i64>(offset_y, 0);
+    const i64 row_end = std::min<i64>(static_cast<i64>(offset_y) + other.height, height);
+    if (column_first >= column_end || row_first >= row_end) {
+        return false;
+    }
+
+    // bits outside the overlap are 0 in one mask or the other (padding, or rowBits past the row), so whole
+    // words can be ANDed without masking the edges
+    const i64 word_first = column_first / 64;
+    const i64 word_last = (column_end - 1) / 64;
+    for (i64 row = row_first; row < row_end; row++) {
+        const u64* mine = words + static_cast<std::size_t>(row) * words_per_row;
+        const u64* theirs = other.words + static_cast<std::size_t>(row - offset_y) * other.words_per_row;
+        for (i64 word = word_first; word <= word_last; word++) {
+            if ((mine[word] & rowBits(theirs, other.words_per_row, word * 64 - offset_x)) != 0) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+PixelMaskSet::PixelMaskSet(std::vector<Entry> entries, std::vector<u64> words, const u8 alpha_threshold)
+: m_entries(std::move(entries)),
+  m_words(std::move(words)),
+  m_alpha_threshold(alpha_threshold) {}
+
+PixelMask PixelMaskSet::mask(const std::size_t index) const noexcept {
+    if (index >= m_entries.size()) {
+        return PixelMask {};
+    }
+
+    const Entry& entry = m_entries[index];
+    return PixelMask {
+        m_words.data() + entry.first_word,
+        entry.width,
+        entry.height,
+        (entry.width + 63) / 64,
+    };
+}
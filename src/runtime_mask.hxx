@@ -0,0 +1,54 @@
+#ifndef RUNTIME_MASK_HXX_INCLUDED
+#define RUNTIME_MASK_HXX_INCLUDED
+
+#include "amb_types.hxx"
+
+#include <cstddef>
+#include <vector>
+
+// non-owning view of one atlas record's pixel mask: one bit per pixel, bit 0 of each row's first word is the
+// leftmost pixel, rows padded to whole u64 words with zero bits
+struct PixelMask {
+    const u64* words = nullptr;
+    u32 width = 0;
+    u32 height = 0;
+    u32 words_per_row = 0;
+
+    bool empty() const noexcept { return width == 0 || height == 0; }
+
+    bool test(u32 x, u32 y) const noexcept {
+        return x < width && y < height && ((words[static_cast<std::size_t>(y) * words_per_row + x / 64] >> (x % 64)) & 1u) != 0;
+    }
+
+    // true when a set pixel of this mask meets a set pixel of `other` placed `offset_x`, `offset_y` pixels
+    // right of / below this mask's top-left corner. compares 64 pixels per AND
+    bool overlaps(const PixelMask& other, i32 offset_x, i32 offset_y) const noexcept;
+};
+
+// every mask of one atlas, indexed like AtlasRuntime::rects
+class PixelMaskSet {
+public:
+    struct Entry {
+        u32 width = 0;
+        u32 height = 0;
+        u32 first_word = 0;
+    };
+
+    PixelMaskSet() = default;
+    PixelMaskSet(std::vector<Entry> entries, std::vector<u64> words, u8 alpha_threshold);
+
+    bool empty() const noexcept { return m_entries.empty(); }
+    std::size_t size() const noexcept { return m_entries.size(); }
+    u8 alphaThreshold() const noexcept { return m_alpha_threshold; }
+    std::size_t byteSize() const noexcept { return m_entries.size() * sizeof(Entry) + m_words.size() * sizeof(u64); }
+
+    // empty mask when `index` is out of range
+    PixelMask mask(std::size_t index) const noexcept;
+
+private:
+    std::vector<Entry> m_entries;
+    std::vector<u64> m_words;
+    u8 m_alpha_threshold = 0;
+};
+
+#endif
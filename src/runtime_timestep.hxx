@@ -0,0 +1,91 @@
+#ifndef RUNTIME_TIMESTEP_HXX_INCLUDED
+#define RUNTIME_TIMESTEP_HXX_INCLUDED
+
+#include "amb_types.hxx"
+
+#include <algorithm>
+
+namespace amb::runtime {
+    // counters for tuning the catch-up cap; times are nanoseconds
+    struct TimestepStats {
+        u64 frames = 0;
+        u64 steps = 0;
+        u32 last_steps = 0;          // update steps run by the latest frame
+        u32 max_steps = 0;
+        u64 capped_frames = 0;       // frames that hit the step cap
+        u64 dropped_ns = 0;          // simulation time thrown away by the cap
+        u64 last_update_ns = 0;
+        u64 max_update_ns = 0;
+        u64 last_render_ns = 0;
+        u64 max_render_ns = 0;
+    };
+}
+
+// fixed-step scheduler: wall time accumulates, each frame runs whole steps up to a hard cap and drops
+// whatever the cap left over, so one slow frame cannot snowball into ever longer catch-up frames
+class FixedTimestep {
+public:
+    FixedTimestep(u64 step_ns, u32 max_steps) noexcept
+    : m_step_ns(std::max<u64>(step_ns, 1)),
+      m_max_steps(std::max<u32>(max_steps, 1)) {}
+
+    // restarts accumulation at `now_ns`, e.g. after a pause, without counting the gap as dropped
+    void reset(u64 now_ns) noexcept {
+        m_last_ns = now_ns;
+        m_accumulator_ns = 0;
+    }
+
+    // returns how many update steps the frame starting at `now_ns` must run
+    u32 advance(u64 now_ns) noexcept {
+        m_accumulator_ns += (now_ns > m_last_ns) ? now_ns - m_last_ns : 0;
+        m_last_ns = now_ns;
+
+        u32 steps = static_cast<u32>(std::min<u64>(m_accumulator_ns / m_step_ns, m_max_steps));
+        m_accumulator_ns -= static_cast<u64>(steps) * m_step_ns;
+
+        if (m_accumulator_ns >= m_step_ns) {
+            // keep the sub-step remainder so alpha stays continuous, drop the whole steps beyond the cap
+            const u64 excess_ns = m_accumulator_ns - m_accumulator_ns % m_step_ns;
+            m_accumulator_ns -= excess_ns;
+            m_stats.dropped_ns += excess_ns;
+            m_stats.capped_frames++;
+        }
+
+        m_stats.frames++;
+        m_stats.steps += steps;
+        m_stats.last_steps = steps;
+        m_stats.max_steps = std::max(m_stats.max_steps, steps);
+        return steps;
+    }
+
+    // how far the render falls between the previous and the current update state, in [0, 1)
+    float alpha() const noexcept {
+        return static_cast<float>(static_cast<double>(m_accumulator_ns) / static_cast<double>(m_step_ns));
+    }
+
+    void recordUpdate(u64 elapsed_ns) noexcept {
+        m_stats.last_update_ns = elapsed_ns;
+        m_stats.max_update_ns = std::max(m_stats.max_update_ns, elapsed_ns);
+    }
+
+    void recordRender(u64 elapsed_ns) noexcept {
+        m_stats.last_render_ns = elapsed_ns;
+        m_stats.max_render_ns = std::max(m_stats.max_render_ns, elapsed_ns);
+    }
+
+    // time until the next step is due, as of the latest advance()
+    u64 untilNextStepNs() const noexcept { return m_step_ns - m_accumulator_ns; }
+
+    u64 stepNs() const noexcept { return m_step_ns; }
+    u32 maxSteps() const noexcept { return m_max_steps; }
+    const amb::runtime::TimestepStats& stats() const noexcept { return m_stats; }
+
+private:
+    u64 m_step_ns;
+    u32 m_max_steps;
+    u64 m_last_ns = 0;
+    u64 m_accumulator_ns = 0;
+    amb::runtime::TimestepStats m_stats;
+};
+
+#endif
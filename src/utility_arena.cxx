@@ -0,0 +1,43 @@
+#include "utility_arena.hxx"
+
+#include <algorithm>
+
+namespace amb::utility {
+    u8* ScratchArena::allocate(const std::size_t size) {
+        const std::size_t aligned_size = (size + 7u) & ~std::size_t{7};
+
+        if (!m_blocks.empty()) {
+            Block& block = m_blocks.back();
+            if (block.size - block.used >= aligned_size) {
+                u8* result = block.data.get() + block.used;
+                block.used += aligned_size;
+                return result;
+            }
+        }
+
+        const std::size_t block_size = std::max(aligned_size, m_block_size);
+        m_blocks.push_back(Block {std::unique_ptr<u8[]>(new u8[block_size]), block_size, aligned_size});
+        return m_blocks.back().data.get();
+    }
+
+    void ScratchArena::reset() {
+        if (m_blocks.size() > 1) {
+            const std::size_t total = capacity();
+            m_blocks.clear();
+            m_blocks.push_back(Block {std::unique_ptr<u8[]>(new u8[total]), total, 0});
+            return;
+        }
+
+        for (Block& block : m_blocks) {
+            block.used = 0;
+        }
+    }
+
+    std::size_t ScratchArena::capacity() const noexcept {
+        std::size_t total = 0;
+        for (const Block& block : m_blocks) {
+            total += block.size;
+        }
+        return total;
+    }
+}
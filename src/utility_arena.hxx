@@ -0,0 +1,38 @@
+#ifndef UTILITY_ARENA_HXX_INCLUDED
+#define UTILITY_ARENA_HXX_INCLUDED
+
+#include "amb_types.hxx"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace amb::utility {
+    // bump allocator for short-lived scratch buffers; allocations stay valid and 8-byte aligned until reset()
+    class ScratchArena {
+    public:
+        explicit ScratchArena(std::size_t block_size = DEFAULT_BLOCK_SIZE)
+        : m_block_size(block_size) {}
+
+        u8* allocate(std::size_t size);
+
+        // releases every allocation; capacity is kept (coalesced into one block) for the next round
+        void reset();
+
+        std::size_t capacity() const noexcept;
+
+        static constexpr std::size_t DEFAULT_BLOCK_SIZE = 1u << 20;
+
+    private:
+        struct Block {
+            std::unique_ptr<u8[]> data;
+            std::size_t size = 0;
+            std::size_t used = 0;
+        };
+
+        std::vector<Block> m_blocks;
+        std::size_t m_block_size;
+    };
+}
+
+#endif
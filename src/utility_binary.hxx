@@ -4,25 +4,93 @@
 #include "amb_types.hxx"
 #include "config.hxx"
 
+#include <cstddef>
 #include <cstring>
-#include <fstream>
 #include <stdexcept>
 #include <string>
 #include <type_traits>
 #include <vector>
 
 namespace amb::utility {
+    // non-owning, bounds-checked view over a contiguous byte range
+    class ByteSpan {
+    public:
+        ByteSpan() = default;
+        ByteSpan(const u8* data, std::size_t size) noexcept
+        : m_data(data), m_size(size) {}
+
+        const u8* data() const noexcept { return m_data; }
+        std::size_t size() const noexcept { return m_size; }
+        bool empty() const noexcept { return m_size == 0; }
+
+        ByteSpan subspan(u64 offset, u64 size, const std::string& context) const {
+            if (offset > static_cast<u64>(m_size) || size > static_cast<u64>(m_size) - offset) {
+                throw std::runtime_error("Out of bounds access for " + context + ".");
+            }
+
+            return ByteSpan(m_data + offset, static_cast<std::size_t>(size));
+        }
+
+        ByteSpan subspan(u64 offset, const std::string& context) const {
+            if (offset > static_cast<u64>(m_size)) {
+                throw std::runtime_error("Out of bounds access for " + context + ".");
+            }
+
+            return ByteSpan(m_data + offset, m_size - static_cast<std::size_t>(offset));
+        }
+
+    private:
+        const u8* m_data = nullptr;
+        std::size_t m_size = 0;
+    };
+
+    // typed view over records stored in place inside a ByteSpan
+    template <typename T>
+    class PodSpan {
+    public:
+        PodSpan() = default;
+        PodSpan(const T* data, std::size_t count) noexcept
+        : m_data(data), m_count(count) {}
+
+        const T* data() const noexcept { return m_data; }
+        std::size_t size() const noexcept { return m_count; }
+        bool empty() const noexcept { return m_count == 0; }
+
+        const T* begin() const noexcept { return m_data; }
+        const T* end() const noexcept { return m_data + m_count; }
+
+        const T& operator[](std::size_t index) const noexcept { return m_data[index]; }
+
+    private:
+        const T* m_data = nullptr;
+        std::size_t m_count = 0;
+    };
+
     template <typename T>
-    T readPod(std::ifstream& stream, const std::string& context) {
+    T readPod(const ByteSpan& bytes, u64 offset, const std::string& context) {
         static_assert(std::is_trivially_copyable_v<T>, "readPod requires trivially copyable types.");
 
+        const ByteSpan source = bytes.subspan(offset, sizeof(T), context);
+
         T value {};
-        stream.read(reinterpret_cast<char*>(&value), sizeof(T));
-        if (!stream) {
-            throw std::runtime_error("Failed to read " + context + ".");
+        std::memcpy(&value, source.data(), sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    PodSpan<T> viewPodArray(const ByteSpan& bytes, u64 offset, u64 count, const std::string& context) {
+        static_assert(std::is_trivially_copyable_v<T>, "viewPodArray requires trivially copyable types.");
+
+        if (count > static_cast<u64>(bytes.size()) / sizeof(T)) {
+            throw std::runtime_error("Out of bounds access for " + context + ".");
         }
 
-        return value;
+        const ByteSpan source = bytes.subspan(offset, count * sizeof(T), context);
+        if ((reinterpret_cast<std::uintptr_t>(source.data()) % alignof(T)) != 0) {
+            throw std::runtime_error("Misaligned data for " + context + ".");
+        }
+
+        return PodSpan<T>(reinterpret_cast<const T*>(source.data()), static_cast<std::size_t>(count));
     }
 
     template <typename T>
@@ -0,0 +1,60 @@
+#include "utility_crc.hxx"
+
+#include <cstring>
+
+namespace amb::utility {
+    namespace {
+        struct Crc32Tables {
+            u32 table[8][256];
+
+            Crc32Tables() noexcept {
+                for (u32 i = 0; i < 256; i++) {
+                    u32 crc = i;
+                    for (int bit = 0; bit < 8; bit++) {
+                        crc = (crc >> 1) ^ ((crc & 1u) ? 0xEDB88320u : 0u);
+                    }
+                    table[0][i] = crc;
+                }
+
+                for (u32 i = 0; i < 256; i++) {
+                    for (int slice = 1; slice < 8; slice++) {
+                        table[slice][i] = (table[slice - 1][i] >> 8) ^ table[0][table[slice - 1][i] & 0xFFu];
+                    }
+                }
+            }
+        };
+
+        const Crc32Tables& tables() noexcept {
+            static const Crc32Tables instance;
+            return instance;
+        }
+    }
+
+    u32 crc32(const u8* data, std::size_t size, u32 crc) noexcept {
+        const auto& t = tables().table;
+        crc = ~crc;
+
+        // eight bytes per step; the format is little-endian so the loads match on supported targets
+        while (size >= 8) {
+            u32 lo = 0;
+            u32 hi = 0;
+            std::memcpy(&lo, data, sizeof(lo));
+            std::memcpy(&hi, data + 4, sizeof(hi));
+            lo ^= crc;
+
+            crc = t[7][lo & 0xFFu] ^ t[6][(lo >> 8) & 0xFFu] ^ t[5][(lo >> 16) & 0xFFu] ^ t[4][lo >> 24] ^
+                  t[3][hi & 0xFFu] ^ t[2][(hi >> 8) & 0xFFu] ^ t[1][(hi >> 16) & 0xFFu] ^ t[0][hi >> 24];
+
+            data += 8;
+            size -= 8;
+        }
+
+        while (size > 0) {
+            crc = (crc >> 8) ^ t[0][(crc ^ *data) & 0xFFu];
+            data++;
+            size--;
+        }
+
+        return ~crc;
+    }
+}
@@ -0,0 +1,13 @@
+#ifndef UTILITY_CRC_HXX_INCLUDED
+#define UTILITY_CRC_HXX_INCLUDED
+
+#include "amb_types.hxx"
+
+#include <cstddef>
+
+namespace amb::utility {
+    // CRC-32 (IEEE 802.3, reflected 0xEDB88320), slice-by-8. Pass a previous result as `crc` to continue a running checksum.
+    u32 crc32(const u8* data, std::size_t size, u32 crc = 0) noexcept;
+}
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef UTILITY_HISTOGRAM_HXX_INCLUDED
+#define UTILITY_HISTOGRAM_HXX_INCLUDED
+
+#include "amb_types.hxx"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace amb::utility {
+    // nearest-rank percentile over sorted, non-empty samples; `p` in [0, 100]
+    inline double sortedPercentile(const std::vector<double>& sorted, double p) noexcept {
+        const std::size_t rank = static_cast<std::size_t>(p / 100.0 * static_cast<double>(sorted.size()) + 0.5);
+        return sorted[std::min(sorted.size() - 1, (rank == 0) ? 0 : rank - 1)];
+    }
+
+    // fixed 0.1 ms buckets up to 200 ms, so adding a sample never allocates; longer samples share the
+    // last bucket and percentiles resolve to a bucket's upper edge
+    class DurationHistogram {
+    public:
+        static constexpr u64 BUCKET_NS = 100'000;
+        static constexpr std::size_t BUCKET_COUNT = 2000;
+
+        void add(u64 duration_ns) noexcept {
+            m_buckets[std::min<u64>(duration_ns / BUCKET_NS, BUCKET_COUNT - 1)]++;
+            m_count++;
+            m_max_ns = std::max(m_max_ns, duration_ns);
+        }
+
+        // `p` in [0, 100]; 0 when empty
+        u64 percentileNs(double p) const noexcept {
+            if (m_count == 0) {
+                return 0;
+            }
+
+            const u64 rank = std::max<u64>(1, static_cast<u64>(p / 100.0 * static_cast<double>(m_count) + 0.5));
+            u64 seen = 0;
+            for (std::size_t bucket = 0; bucket < BUCKET_COUNT; bucket++) {
+                seen += m_buckets[bucket];
+                if (seen >= rank) {
+                    return std::min((static_cast<u64>(bucket) + 1) * BUCKET_NS, m_max_ns);
+                }
+            }
+
+            return m_max_ns;
+        }
+
+        u64 count() const noexcept { return m_count; }
+        u64 maxNs() const noexcept { return m_max_ns; }
+
+        void reset() noexcept {
+            m_buckets.fill(0);
+            m_count = 0;
+            m_max_ns = 0;
+        }
+
+    private:
+        std::array<u32, BUCKET_COUNT> m_buckets {};
+        u64 m_count = 0;
+        u64 m_max_ns = 0;
+    };
+}
+
+#endif
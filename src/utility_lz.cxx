@@ -0,0 +1,177 @@
+#include "utility_lz.hxx"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace amb::utility {
+    namespace {
+        constexpr std::size_t MIN_MATCH = 4;
+        constexpr std::size_t LAST_LITERALS = 5;
+        constexpr std::size_t MATCH_SAFE_DISTANCE = 12;
+        constexpr std::size_t MAX_OFFSET = 65535;
+        constexpr u32 HASH_BITS = 16;
+
+        u32 read32(const u8* p) noexcept {
+            u32 value = 0;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        u32 hash4(u32 sequence) noexcept {
+            return (sequence * 2654435761u) >> (32 - HASH_BITS);
+        }
+
+        void writeLength(std::vector<u8>& out, std::size_t length) {
+            while (length >= 255) {
+                out.push_back(255);
+                length -= 255;
+            }
+            out.push_back(static_cast<u8>(length));
+        }
+
+        void emitSequence(std::vector<u8>& out, const u8* literals, std::size_t literal_length, std::size_t offset, std::size_t match_length) {
+            const std::size_t match_code = (match_length >= MIN_MATCH) ? match_length - MIN_MATCH : 0;
+
+            const u8 token = static_cast<u8>(
+                ((literal_length >= 15 ? 15 : literal_length) << 4) |
+                (match_length == 0 ? 0 : (match_code >= 15 ? 15 : match_code)));
+            out.push_back(token);
+
+            if (literal_length >= 15) {
+                writeLength(out, literal_length - 15);
+            }
+            out.insert(out.end(), literals, literals + literal_length);
+
+            if (match_length == 0) {
+                return;
+            }
+
+            out.push_back(static_cast<u8>(offset & 0xFF));
+            out.push_back(static_cast<u8>((offset >> 8) & 0xFF));
+            if (match_code >= 15) {
+                writeLength(out, match_code - 15);
+            }
+        }
+
+        std::size_t readLength(const u8*& ip, const u8* end) {
+            std::size_t length = 0;
+            u8 byte = 0;
+            do {
+                if (ip >= end) {
+                    throw std::runtime_error("LZ stream truncated inside a length field.");
+                }
+                byte = *ip++;
+                length += byte;
+            } while (byte == 255);
+
+            return length;
+        }
+    }
+
+    std::vector<u8> lzCompress(const u8* src, std::size_t src_size) {
+        std::vector<u8> out;
+        out.reserve(src_size + (src_size / 255) + 16);
+
+        std::vector<u32> table(std::size_t{1} << HASH_BITS, 0);
+
+        std::size_t anchor = 0;
+        std::size_t pos = 0;
+
+        if (src_size > MATCH_SAFE_DISTANCE) {
+            const std::size_t match_limit = src_size - LAST_LITERALS;
+            const std::size_t search_limit = src_size - MATCH_SAFE_DISTANCE;
+
+            while (pos <= search_limit) {
+                const u32 sequence = read32(src + pos);
+                const u32 slot = hash4(sequence);
+                const std::size_t candidate = table[slot];
+                table[slot] = static_cast<u32>(pos);
+
+                if (candidate >= pos || pos - candidate > MAX_OFFSET || read32(src + candidate) != sequence) {
+                    pos++;
+                    continue;
+                }
+
+                std::size_t match_length = MIN_MATCH;
+                while (pos + match_length < match_limit && src[candidate + match_length] == src[pos + match_length]) {
+                    match_length++;
+                }
+
+                emitSequence(out, src + anchor, pos - anchor, pos - candidate, match_length);
+
+                pos += match_length;
+                anchor = pos;
+            }
+        }
+
+        emitSequence(out, src + anchor, src_size - anchor, 0, 0);
+        return out;
+    }
+
+    void lzDecompress(const ByteSpan& src, u8* dst, std::size_t dst_size) {
+        const u8* ip = src.data();
+        const u8* const ip_end = src.data() + src.size();
+        u8* op = dst;
+        u8* const op_end = dst + dst_size;
+
+        while (ip < ip_end) {
+            const u8 token = *ip++;
+
+            std::size_t literal_length = token >> 4;
+            if (literal_length == 15) {
+                literal_length += readLength(ip, ip_end);
+            }
+
+            if (literal_length > static_cast<std::size_t>(ip_end - ip) || literal_length > static_cast<std::size_t>(op_end - op)) {
+                throw std::runtime_error("LZ literal run overflows input or output buffer.");
+            }
+
+            if (literal_length > 0) {
+                std::memcpy(op, ip, literal_length);
+            }
+            ip += literal_length;
+            op += literal_length;
+
+            // the final sequence carries literals only
+            if (ip == ip_end) {
+                break;
+            }
+
+            if (ip_end - ip < 2) {
+                throw std::runtime_error("LZ stream truncated inside a match offset.");
+            }
+
+            const std::size_t offset = static_cast<std::size_t>(ip[0]) | (static_cast<std::size_t>(ip[1]) << 8);
+            ip += 2;
+
+            if (offset == 0 || offset > static_cast<std::size_t>(op - dst)) {
+                throw std::runtime_error("LZ match offset points outside decoded data.");
+            }
+
+            std::size_t match_length = token & 0x0F;
+            if (match_length == 15) {
+                match_length += readLength(ip, ip_end);
+            }
+            match_length += MIN_MATCH;
+
+            if (match_length > static_cast<std::size_t>(op_end - op)) {
+                throw std::runtime_error("LZ match overflows output buffer.");
+            }
+
+            const u8* match = op - offset;
+            if (offset >= match_length) {
+                std::memcpy(op, match, match_length);
+                op += match_length;
+            } else {
+                // overlapping copy repeats the last `offset` bytes
+                for (std::size_t i = 0; i < match_length; i++) {
+                    *op++ = *match++;
+                }
+            }
+        }
+
+        if (op != op_end) {
+            throw std::runtime_error("LZ stream decoded to an unexpected size.");
+        }
+    }
+}
@@ -0,0 +1,18 @@
+#ifndef UTILITY_LZ_HXX_INCLUDED
+#define UTILITY_LZ_HXX_INCLUDED
+
+#include "amb_types.hxx"
+#include "utility_binary.hxx"
+
+#include <cstddef>
+#include <vector>
+
+namespace amb::utility {
+    // LZ4 block format (no frame header); output is readable by any LZ4 block decoder
+    std::vector<u8> lzCompress(const u8* src, std::size_t src_size);
+
+    // decodes exactly dst_size bytes into dst; throws on malformed or truncated input
+    void lzDecompress(const ByteSpan& src, u8* dst, std::size_t dst_size);
+}
+
+#endif
@@ -84,4 +84,21 @@ namespace amb::utility {
 
         return static_cast<u32>(parsed);
     }
+
+    u32 parseCount(const std::string& value, const std::string& option, const u32 min_value, const u32 max_value) {
+        std::size_t consumed = 0;
+        unsigned long long parsed = 0;
+        try {
+            parsed = std::stoull(value, &consumed, 10);
+        } catch (const std::exception&) {
+            consumed = 0;
+        }
+
+        if (consumed == 0 || consumed != value.size() || parsed < min_value || parsed > max_value) {
+            throw std::runtime_error(
+                option + " expects an integer in [" + std::to_string(min_value) + ", " + std::to_string(max_value) + "], got: " + value);
+        }
+
+        return static_cast<u32>(parsed);
+    }
 }
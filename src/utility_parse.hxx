@@ -4,6 +4,7 @@
 #include "amb_types.hxx"
 
 #include <cstddef>
+#include <limits>
 #include <string>
 #include <utility>
 
@@ -15,6 +16,13 @@ namespace amb::utility {
     i16 parseSigned16(const std::string& value, std::size_t line_number, const std::string& field_name);
     u16 parseUnsigned16(const std::string& value, std::size_t line_number, const std::string& field_name);
     u32 parseUnsigned32(const std::string& value, std::size_t line_number, const std::string& field_name);
+
+    // command-line counts for the tools; `option` names the flag in the error
+    u32 parseCount(
+        const std::string& value,
+        const std::string& option,
+        u32 min_value = 0,
+        u32 max_value = std::numeric_limits<u32>::max());
 }
 
 #endif
@@ -0,0 +1,188 @@
+#include "utility_profile.hxx"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+namespace amb::utility::profile {
+    namespace {
+        // fields are relaxed atomics so a reader copying a slot the writer is reusing is a stale read, not a data race
+        struct Slot {
+            std::atomic<const char*> name {nullptr};
+            std::atomic<u64> start_ns {0};
+            std::atomic<u64> end_ns {0};
+        };
+
+        struct ThreadRing {
+            std::array<Slot, RING_CAPACITY> slots;
+            std::atomic<u64> head {0};  // events ever written; slot = index % RING_CAPACITY
+            std::atomic<const char*> name {nullptr};
+            std::atomic<bool> in_use {true};
+            u32 track = 0;
+        };
+
+        // rings are never freed: a finished thread's ring keeps its events for the trace until a new thread reuses it
+        struct Registry {
+            std::mutex mutex;
+            std::vector<std::unique_ptr<ThreadRing>> rings;
+        };
+
+        Registry& registry() {
+            static Registry instance;
+            return instance;
+        }
+
+        std::chrono::steady_clock::time_point epoch() {
+            static const std::chrono::steady_clock::time_point instance = std::chrono::steady_clock::now();
+            return instance;
+        }
+
+        struct ThreadRingHandle {
+            ThreadRing* ring = nullptr;
+
+            ~ThreadRingHandle() {
+                if (ring != nullptr) {
+                    ring->in_use.store(false, std::memory_order_release);
+                    ring = nullptr;
+                }
+            }
+        };
+
+        thread_local ThreadRingHandle t_ring;
+
+        ThreadRing& threadRing() {
+            if (t_ring.ring != nullptr) {
+                return *t_ring.ring;
+            }
+
+            Registry& shared = registry();
+            const std::lock_guard<std::mutex> lock(shared.mutex);
+            for (const std::unique_ptr<ThreadRing>& ring : shared.rings) {
+                bool expected = false;
+                if (ring->in_use.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                    ring->name.store(nullptr, std::memory_order_relaxed);
+                    t_ring.ring = ring.get();
+                    return *t_ring.ring;
+                }
+            }
+
+            shared.rings.push_back(std::make_unique<ThreadRing>());
+            shared.rings.back()->track = static_cast<u32>(shared.rings.size());
+            t_ring.ring = shared.rings.back().get();
+            return *t_ring.ring;
+        }
+
+        u64 oldestRetained(u64 head) noexcept {
+            return (head > RING_CAPACITY) ? head - RING_CAPACITY : 0;
+        }
+
+        // copies events [max(cursor, oldest), head) and returns head; slots the writer lapped or may be
+        // overwriting meanwhile are dropped
+        u64 copyRing(const ThreadRing& ring, u64 cursor, std::vector<Event>& out) {
+            const u64 head = ring.head.load(std::memory_order_acquire);
+            const u64 first = std::max(cursor, oldestRetained(head));
+            const std::size_t copied_from = out.size();
+
+            for (u64 index = first; index < head; index++) {
+                const Slot& slot = ring.slots[index % RING_CAPACITY];
+                out.push_back(Event {
+                    slot.name.load(std::memory_order_relaxed),
+                    slot.start_ns.load(std::memory_order_relaxed),
+                    slot.end_ns.load(std::memory_order_relaxed),
+                });
+            }
+
+            // the writer may be filling the slot of index `head_now` already, which still holds
+            // head_now - RING_CAPACITY, so that event is dropped as well
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const u64 valid_from = oldestRetained(ring.head.load(std::memory_order_relaxed) + 1);
+            if (valid_from > first) {
+                const std::size_t lapped = static_cast<std::size_t>(std::min(valid_from, head) - first);
+                out.erase(out.begin() + static_cast<std::ptrdiff_t>(copied_from),
+                          out.begin() + static_cast<std::ptrdiff_t>(copied_from + lapped));
+            }
+
+            return head;
+        }
+
+        void writeJsonString(std::ofstream& out, const char* value) {
+            out << '"';
+            for (const char* c = (value != nullptr) ? value : "?"; *c != '\0'; c++) {
+                if (*c == '"' || *c == '\\') {
+                    out << '\\';
+                }
+                out << *c;
+            }
+            out << '"';
+        }
+    }
+
+    u64 nowNs() noexcept {
+        return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - epoch()).count());
+    }
+
+    void record(const char* name, u64 start_ns, u64 end_ns) noexcept {
+        ThreadRing& ring = threadRing();
+        const u64 head = ring.head.load(std::memory_order_relaxed);
+        Slot& slot = ring.slots[head % RING_CAPACITY];
+        slot.name.store(name, std::memory_order_relaxed);
+        slot.start_ns.store(start_ns, std::memory_order_relaxed);
+        slot.end_ns.store(end_ns, std::memory_order_relaxed);
+        ring.head.store(head + 1, std::memory_order_release);
+    }
+
+    void setThreadName(const char* name) {
+        threadRing().name.store(name, std::memory_order_relaxed);
+    }
+
+    std::size_t readThreadEvents(u64& cursor, std::vector<Event>& out) {
+        const std::size_t before = out.size();
+        cursor = copyRing(threadRing(), cursor, out);
+        return out.size() - before;
+    }
+
+    bool writeChromeTrace(const std::filesystem::path& path) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            return false;
+        }
+
+        Registry& shared = registry();
+        const std::lock_guard<std::mutex> lock(shared.mutex);
+
+        // complete ("X") events in microseconds, plus one thread_name metadata record per ring
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        bool first = true;
+        std::vector<Event> events;
+        for (const std::unique_ptr<ThreadRing>& ring : shared.rings) {
+            const char* thread_name = ring->name.load(std::memory_order_relaxed);
+            if (thread_name != nullptr) {
+                out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->track
+                    << ",\"args\":{\"name\":";
+                writeJsonString(out, thread_name);
+                out << "}}";
+                first = false;
+            }
+
+            events.clear();
+            copyRing(*ring, 0, events);
+            for (const Event& event : events) {
+                out << (first ? "" : ",") << "\n{\"name\":";
+                writeJsonString(out, event.name);
+                out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring->track
+                    << ",\"ts\":" << (event.start_ns / 1000) << '.' << ((event.start_ns / 100) % 10)
+                    << ",\"dur\":" << ((event.end_ns - event.start_ns) / 1000) << '.' << (((event.end_ns - event.start_ns) / 100) % 10)
+                    << '}';
+                first = false;
+            }
+        }
+        out << "\n]}\n";
+
+        return static_cast<bool>(out);
+    }
+}
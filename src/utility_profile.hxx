@@ -0,0 +1,65 @@
+#ifndef UTILITY_PROFILE_HXX_INCLUDED
+#define UTILITY_PROFILE_HXX_INCLUDED
+
+#include "amb_types.hxx"
+
+#include <cstddef>
+#include <filesystem>
+#include <vector>
+
+// scoped timers for frame and loader phases. every thread records into its own fixed ring, so the hot
+// path is two clock reads and three relaxed stores; readers copy the rings without stopping writers.
+// building without AMB_PROFILING turns the macros into no-ops
+namespace amb::utility::profile {
+    constexpr std::size_t RING_CAPACITY = 1u << 14;  // events kept per thread
+
+    // `name` must outlive the profiler, in practice a string literal
+    struct Event {
+        const char* name = nullptr;
+        u64 start_ns = 0;
+        u64 end_ns = 0;
+    };
+
+    // nanoseconds since the profiler's epoch
+    u64 nowNs() noexcept;
+
+    void record(const char* name, u64 start_ns, u64 end_ns) noexcept;
+
+    // labels the calling thread's track in the trace; `name` must outlive the profiler
+    void setThreadName(const char* name);
+
+    // appends the calling thread's events recorded after `cursor` and advances it; events the ring
+    // already overwrote are skipped. returns the number appended
+    std::size_t readThreadEvents(u64& cursor, std::vector<Event>& out);
+
+    // writes every thread's retained events as Chrome trace JSON (chrome://tracing, Perfetto)
+    bool writeChromeTrace(const std::filesystem::path& path);
+
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(const char* name) noexcept
+        : m_name(name), m_start_ns(nowNs()) {}
+
+        ~ScopedTimer() { record(m_name, m_start_ns, nowNs()); }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        const char* m_name;
+        u64 m_start_ns;
+    };
+}
+
+#define AMB_PROFILE_CONCAT_INNER(a, b) a##b
+#define AMB_PROFILE_CONCAT(a, b) AMB_PROFILE_CONCAT_INNER(a, b)
+
+#if defined(AMB_PROFILING)
+#define AMB_PROFILE_SCOPE(name) const ::amb::utility::profile::ScopedTimer AMB_PROFILE_CONCAT(amb_profile_scope_, __LINE__) {name}
+#define AMB_PROFILE_THREAD(name) ::amb::utility::profile::setThreadName(name)
+#else
+#define AMB_PROFILE_SCOPE(name) ((void)0)
+#define AMB_PROFILE_THREAD(name) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,133 @@
+#include "utility_simd.hxx"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+#if !defined(__AVX2__) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define AMB_UTILITY_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace amb::utility {
+    namespace {
+        u16 gatherHighU16WithMaxScalar(const u8* src, std::size_t pair_count, u16* out, u16 max_value) noexcept {
+            for (std::size_t i = 0; i < pair_count; i++) {
+                u16 value = 0;
+                std::memcpy(&value, src + (i * 4) + 2, sizeof(value));
+                out[i] = value;
+                max_value = std::max(max_value, value);
+            }
+
+            return max_value;
+        }
+
+        void addScaledClampedScalar(
+            float* values, const float* deltas, std::size_t count, float scale, float min_value, float max_value) noexcept
+        {
+            for (std::size_t i = 0; i < count; i++) {
+                values[i] = std::min(std::max(values[i] + deltas[i] * scale, min_value), max_value);
+            }
+        }
+    }
+
+#if defined(__AVX2__)
+    u16 gatherHighU16WithMax(const u8* src, std::size_t pair_count, u16* out) noexcept {
+        constexpr std::size_t LANES = 16;
+        const std::size_t vector_count = pair_count - (pair_count % LANES);
+
+        __m256i max_lanes = _mm256_setzero_si256();
+        for (std::size_t i = 0; i < vector_count; i += LANES) {
+            const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + (i * 4)));
+            const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + (i * 4) + 32));
+
+            // arithmetic shift keeps the high half representable as i16, so the signed pack is lossless
+            const __m256i packed = _mm256_packs_epi32(_mm256_srai_epi32(lo, 16), _mm256_srai_epi32(hi, 16));
+            const __m256i ordered = _mm256_permute4x64_epi64(packed, 0xD8);
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), ordered);
+            max_lanes = _mm256_max_epu16(max_lanes, ordered);
+        }
+
+        alignas(32) u16 lanes[LANES];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), max_lanes);
+        const u16 max_value = *std::max_element(lanes, lanes + LANES);
+
+        return gatherHighU16WithMaxScalar(src + (vector_count * 4), pair_count - vector_count, out + vector_count, max_value);
+    }
+#elif defined(AMB_UTILITY_SSE2)
+    u16 gatherHighU16WithMax(const u8* src, std::size_t pair_count, u16* out) noexcept {
+        constexpr std::size_t LANES = 8;
+        const std::size_t vector_count = pair_count - (pair_count % LANES);
+
+        // SSE2 only has a signed 16-bit max; bias into signed range and back
+        const __m128i bias = _mm_set1_epi16(static_cast<short>(0x8000));
+        __m128i max_lanes = _mm_set1_epi16(static_cast<short>(0x8000));
+
+        for (std::size_t i = 0; i < vector_count; i += LANES) {
+            const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + (i * 4)));
+            const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + (i * 4) + 16));
+
+            // arithmetic shift keeps the high half representable as i16, so the signed pack is lossless
+            const __m128i packed = _mm_packs_epi32(_mm_srai_epi32(lo, 16), _mm_srai_epi32(hi, 16));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+            max_lanes = _mm_max_epi16(max_lanes, _mm_xor_si128(packed, bias));
+        }
+
+        alignas(16) u16 lanes[LANES];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), _mm_xor_si128(max_lanes, bias));
+        const u16 max_value = *std::max_element(lanes, lanes + LANES);
+
+        return gatherHighU16WithMaxScalar(src + (vector_count * 4), pair_count - vector_count, out + vector_count, max_value);
+    }
+#else
+    u16 gatherHighU16WithMax(const u8* src, std::size_t pair_count, u16* out) noexcept {
+        return gatherHighU16WithMaxScalar(src, pair_count, out, 0);
+    }
+#endif
+
+#if defined(__AVX__)
+    void addScaledClamped(
+        float* values, const float* deltas, std::size_t count, float scale, float min_value, float max_value) noexcept
+    {
+        constexpr std::size_t LANES = 8;
+        const std::size_t vector_count = count - (count % LANES);
+
+        const __m256 scale_lanes = _mm256_set1_ps(scale);
+        const __m256 min_lanes = _mm256_set1_ps(min_value);
+        const __m256 max_lanes = _mm256_set1_ps(max_value);
+        for (std::size_t i = 0; i < vector_count; i += LANES) {
+            const __m256 moved = _mm256_add_ps(_mm256_loadu_ps(values + i), _mm256_mul_ps(_mm256_loadu_ps(deltas + i), scale_lanes));
+            _mm256_storeu_ps(values + i, _mm256_min_ps(_mm256_max_ps(moved, min_lanes), max_lanes));
+        }
+
+        addScaledClampedScalar(values + vector_count, deltas + vector_count, count - vector_count, scale, min_value, max_value);
+    }
+#elif defined(AMB_UTILITY_SSE2)
+    void addScaledClamped(
+        float* values, const float* deltas, std::size_t count, float scale, float min_value, float max_value) noexcept
+    {
+        constexpr std::size_t LANES = 4;
+        const std::size_t vector_count = count - (count % LANES);
+
+        const __m128 scale_lanes = _mm_set1_ps(scale);
+        const __m128 min_lanes = _mm_set1_ps(min_value);
+        const __m128 max_lanes = _mm_set1_ps(max_value);
+        for (std::size_t i = 0; i < vector_count; i += LANES) {
+            const __m128 moved = _mm_add_ps(_mm_loadu_ps(values + i), _mm_mul_ps(_mm_loadu_ps(deltas + i), scale_lanes));
+            _mm_storeu_ps(values + i, _mm_min_ps(_mm_max_ps(moved, min_lanes), max_lanes));
+        }
+
+        addScaledClampedScalar(values + vector_count, deltas + vector_count, count - vector_count, scale, min_value, max_value);
+    }
+#else
+    void addScaledClamped(
+        float* values, const float* deltas, std::size_t count, float scale, float min_value, float max_value) noexcept
+    {
+        addScaledClampedScalar(values, deltas, count, scale, min_value, max_value);
+    }
+#endif
+}
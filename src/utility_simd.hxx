@@ -0,0 +1,18 @@
+#ifndef UTILITY_SIMD_HXX_INCLUDED
+#define UTILITY_SIMD_HXX_INCLUDED
+
+#include "amb_types.hxx"
+
+#include <cstddef>
+
+namespace amb::utility {
+    // Copies the second u16 of each 4-byte (u16, u16) pair in `src` into `out` and returns the largest value copied
+    // (0 when pair_count is 0). `src` needs no particular alignment. Uses AVX2 or SSE2 when the target supports it.
+    u16 gatherHighU16WithMax(const u8* src, std::size_t pair_count, u16* out) noexcept;
+
+    // values[i] = clamp(values[i] + deltas[i] * scale, min_value, max_value) for `count` floats; neither array needs
+    // alignment. Uses AVX or SSE when the target supports it.
+    void addScaledClamped(float* values, const float* deltas, std::size_t count, float scale, float min_value, float max_value) noexcept;
+}
+
+#endif
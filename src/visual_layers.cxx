@@ -0,0 +1,509 @@
+#include "visual_layers.hxx"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr std::size_t VERTICES_PER_QUAD = 4;
+    constexpr std::size_t INDICES_PER_QUAD = 6;
+
+    // non-negative remainder, so negative tiles map onto the ring like positive ones
+    i32 wrapTile(const i32 value, const i32 count) noexcept {
+        const i32 remainder = value % count;
+        return (remainder < 0) ? remainder + count : remainder;
+    }
+
+    float wrapPixel(const float value, const float extent) noexcept {
+        const float remainder = std::fmod(value, extent);
+        return (remainder < 0.0f) ? remainder + extent : remainder;
+    }
+}
+
+void MapLayer::render(SDL_Renderer* renderer) {
+    resetRenderStats();
+    if (renderer == nullptr || image().texture == nullptr || amb::game::MAP_TILE_SIZE == 0) {
+        return;
+    }
+
+    SDL_Rect viewport {0, 0, 0, 0};
+    if (!SDL_GetRenderViewport(renderer, &viewport)) {
+        SDL_Log("MapLayer::render failed to query viewport: %s", SDL_GetError());
+        return;
+    }
+
+    if (viewport.w <= 0 || viewport.h <= 0) {
+        return;
+    }
+
+    if (m_cache_enabled) {
+        renderCached(renderer, viewport);
+    } else {
+        renderBatched(renderer, viewport);
+    }
+}
+
+void MapLayer::setRenderCacheEnabled(const bool enabled) noexcept {
+    m_cache_enabled = enabled;
+    if (!enabled) {
+        m_cache_texture.reset();
+    }
+
+    m_cache_valid = false;
+    m_geometry_dirty = true;
+    markContentDirty();
+}
+
+void MapLayer::setHiddenTiles(std::vector<u64> hidden_tiles) noexcept {
+    m_hidden_tiles = std::move(hidden_tiles);
+    m_geometry_dirty = true;
+    m_cache_valid = false;
+    markContentDirty();
+}
+
+void MapLayer::renderBatched(SDL_Renderer* renderer, const SDL_Rect& viewport) {
+    const amb::runtime::CameraView& camera_view = view();
+
+    // only tiles under the camera rect are built, however large the map is
+    TileRange range {};
+    m_map_runtime.clampVisibleWorldToTileRange(
+        camera_view.world_x,
+        camera_view.world_y,
+        std::ceil(camera_view.world_x + viewWorldWidth(viewport)),
+        std::ceil(camera_view.world_y + viewWorldHeight(viewport)),
+        range.min_tx,
+        range.max_tx,
+        range.min_ty,
+        range.max_ty);
+
+    if (range.max_tx < range.min_tx || range.max_ty < range.min_ty) {
+        return;
+    }
+
+    if (m_geometry_dirty || !(range == m_geometry_range) || camera_view.zoom != m_geometry_view.zoom) {
+        rebuildGeometry(range);
+    } else {
+        if (!(camera_view == m_geometry_view)) {
+            // same tiles, sub-tile scroll: shift the existing quads instead of rebuilding them
+            const float delta_x = (m_geometry_view.world_x - camera_view.world_x) * camera_view.zoom;
+            const float delta_y = (m_geometry_view.world_y - camera_view.world_y) * camera_view.zoom;
+            for (SDL_Vertex& vertex : m_vertices) {
+                vertex.position.x += delta_x;
+                vertex.position.y += delta_y;
+            }
+
+            m_geometry_view = camera_view;
+        }
+
+        if (m_geometry_animation != m_animator.version()) {
+            refreshAnimatedQuads();
+        }
+    }
+
+    if (m_quad_count == 0) {
+        return;
+    }
+
+    if (!SDL_RenderGeometry(
+        renderer,
+        image().texture.get(),
+        m_vertices.data(),
+        static_cast<int>(m_quad_count * VERTICES_PER_QUAD),
+        m_indices.data(),
+        static_cast<int>(m_quad_count * INDICES_PER_QUAD))) {
+        SDL_Log("MapLayer::render failed to submit tile geometry: %s", SDL_GetError());
+    }
+    countDrawCall(m_quad_count);
+}
+
+void MapLayer::renderCached(SDL_Renderer* renderer, const SDL_Rect& viewport) {
+    if (!ensureCacheTexture(renderer, viewport)) {
+        renderBatched(renderer, viewport);
+        return;
+    }
+
+    float texture_w = 0.0f;
+    float texture_h = 0.0f;
+    if (!queryAtlasSize(texture_w, texture_h)) {
+        return;
+    }
+
+    // unclamped, so tiles outside the map are cleared in the ring instead of keeping stale pixels
+    const amb::runtime::CameraView& camera_view = view();
+    const float tile_size = static_cast<float>(amb::game::MAP_TILE_SIZE);
+    const TileRange range {
+        static_cast<i32>(std::floor(camera_view.world_x / tile_size)),
+        static_cast<i32>(std::ceil((camera_view.world_x + viewWorldWidth(viewport)) / tile_size)) - 1,
+        static_cast<i32>(std::floor(camera_view.world_y / tile_size)),
+        static_cast<i32>(std::ceil((camera_view.world_y + viewWorldHeight(viewport)) / tile_size)) - 1,
+    };
+
+    m_vertices.clear();
+    m_cache_clears.clear();
+    m_geometry_dirty = true;
+
+    if (!m_cache_valid) {
+        m_cache_animated.clear();
+        queueCacheTiles(range, texture_w, texture_h);
+    } else {
+        const TileRange& cached = m_cache_range;
+        if (!(range == cached)) {
+            m_cache_animated.erase(
+                std::remove_if(m_cache_animated.begin(), m_cache_animated.end(), [&range](const TilePosition& tile) {
+                    return tile.x < range.min_tx || tile.x > range.max_tx || tile.y < range.min_ty || tile.y > range.max_ty;
+                }),
+                m_cache_animated.end());
+        }
+
+        // frames changed: only the animated tiles already in the ring are redrawn
+        if (m_cache_animation != m_animator.version()) {
+            for (const TilePosition& tile : m_cache_animated) {
+                queueCacheTile(tile.x, tile.y, texture_w, texture_h, false);
+            }
+        }
+
+        if (!(range == cached)) {
+            // newly exposed columns span the full new height
+            queueCacheTiles({range.min_tx, std::min(range.max_tx, cached.min_tx - 1), range.min_ty, range.max_ty}, texture_w, texture_h);
+            queueCacheTiles({std::max(range.min_tx, cached.max_tx + 1), range.max_tx, range.min_ty, range.max_ty}, texture_w, texture_h);
+
+            // newly exposed rows only need the columns that were already cached
+            const i32 kept_min_tx = std::max(range.min_tx, cached.min_tx);
+            const i32 kept_max_tx = std::min(range.max_tx, cached.max_tx);
+            queueCacheTiles({kept_min_tx, kept_max_tx, range.min_ty, std::min(range.max_ty, cached.min_ty - 1)}, texture_w, texture_h);
+            queueCacheTiles({kept_min_tx, kept_max_tx, std::max(range.min_ty, cached.max_ty + 1), range.max_ty}, texture_w, texture_h);
+        }
+    }
+
+    if (!m_cache_clears.empty() && !flushCacheTiles(renderer)) {
+        m_cache_valid = false;
+        renderBatched(renderer, viewport);
+        return;
+    }
+
+    m_cache_range = range;
+    m_cache_valid = true;
+    m_cache_animation = m_animator.version();
+    blitCache(renderer, viewport);
+}
+
+void MapLayer::rebuildGeometry(const TileRange& range) {
+    float texture_w = 0.0f;
+    float texture_h = 0.0f;
+    if (!queryAtlasSize(texture_w, texture_h)) {
+        m_quad_count = 0;
+        return;
+    }
+
+    const std::size_t tile_count =
+        static_cast<std::size_t>(range.max_tx - range.min_tx + 1) * static_cast<std::size_t>(range.max_ty - range.min_ty + 1);
+    ensureQuadIndices(tile_count);
+
+    m_vertices.clear();
+    m_vertices.reserve(tile_count * VERTICES_PER_QUAD);
+    m_animated_quads.clear();
+
+    const amb::runtime::CameraView& camera_view = view();
+    const std::vector<SDL_FRect>& rects = atlas().rects;
+    const float tile_size = static_cast<float>(amb::game::MAP_TILE_SIZE);
+    const float screen_tile_size = tile_size * camera_view.zoom;
+
+    for (i32 tile_y = range.min_ty; tile_y <= range.max_ty; ++tile_y) {
+        for (i32 tile_x = range.min_tx; tile_x <= range.max_tx; ++tile_x) {
+            const Cell* cell = m_map_runtime.cellAtTile(static_cast<std::size_t>(tile_x), static_cast<std::size_t>(tile_y));
+            if (cell == nullptr || static_cast<std::size_t>(*cell) >= rects.size() ||
+                tileHidden(static_cast<std::size_t>(tile_x), static_cast<std::size_t>(tile_y))) {
+                continue;
+            }
+
+            if (m_animator.animated(*cell)) {
+                m_animated_quads.push_back(AnimatedQuad {m_vertices.size() / VERTICES_PER_QUAD, *cell});
+            }
+
+            appendTileQuad(
+                rects[m_animator.remap(*cell)],
+                (static_cast<float>(tile_x) * tile_size - camera_view.world_x) * camera_view.zoom,
+                (static_cast<float>(tile_y) * tile_size - camera_view.world_y) * camera_view.zoom,
+                screen_tile_size,
+                texture_w,
+                texture_h);
+        }
+    }
+
+    m_quad_count = m_vertices.size() / VERTICES_PER_QUAD;
+    m_geometry_range = range;
+    m_geometry_view = camera_view;
+    m_geometry_dirty = false;
+    m_geometry_animation = m_animator.version();
+    m_texture_w = texture_w;
+    m_texture_h = texture_h;
+}
+
+void MapLayer::refreshAnimatedQuads() {
+    // positions stay put, only the texture coordinates of animated quads move to the current frame
+    const std::vector<SDL_FRect>& rects = atlas().rects;
+    for (const AnimatedQuad& animated : m_animated_quads) {
+        const SDL_FRect& source = rects[m_animator.remap(animated.cell)];
+        const float u0 = source.x / m_texture_w;
+        const float v0 = source.y / m_texture_h;
+        const float u1 = (source.x + source.w) / m_texture_w;
+        const float v1 = (source.y + source.h) / m_texture_h;
+
+        SDL_Vertex* quad = &m_vertices[animated.quad * VERTICES_PER_QUAD];
+        quad[0].tex_coord = SDL_FPoint {u0, v0};
+        quad[1].tex_coord = SDL_FPoint {u1, v0};
+        quad[2].tex_coord = SDL_FPoint {u1, v1};
+        quad[3].tex_coord = SDL_FPoint {u0, v1};
+    }
+
+    m_geometry_animation = m_animator.version();
+}
+
+bool MapLayer::queryAtlasSize(float& texture_w, float& texture_h) const {
+    if (!SDL_GetTextureSize(image().texture.get(), &texture_w, &texture_h) || texture_w <= 0.0f || texture_h <= 0.0f) {
+        SDL_Log("MapLayer::render failed to query texture size: %s", SDL_GetError());
+        return false;
+    }
+
+    return true;
+}
+
+void MapLayer::ensureQuadIndices(const std::size_t quad_count) {
+    // indices are the same for every batch, so they are only extended when a batch grows
+    if (m_indices.size() >= quad_count * INDICES_PER_QUAD) {
+        return;
+    }
+
+    const std::size_t first_quad = m_indices.size() / INDICES_PER_QUAD;
+    m_indices.reserve(quad_count * INDICES_PER_QUAD);
+    for (std::size_t quad = first_quad; quad < quad_count; quad++) {
+        const int base = static_cast<int>(quad * VERTICES_PER_QUAD);
+        m_indices.insert(m_indices.end(), {base, base + 1, base + 2, base + 2, base + 3, base});
+    }
+}
+
+void MapLayer::appendTileQuad(
+    const SDL_FRect& source,
+    const float x,
+    const float y,
+    const float size,
+    const float texture_w,
+    const float texture_h)
+{
+    const SDL_FColor white {1.0f, 1.0f, 1.0f, 1.0f};
+
+    const float u0 = source.x / texture_w;
+    const float v0 = source.y / texture_h;
+    const float u1 = (source.x + source.w) / texture_w;
+    const float v1 = (source.y + source.h) / texture_h;
+
+    m_vertices.push_back(SDL_Vertex {SDL_FPoint {x, y}, white, SDL_FPoint {u0, v0}});
+    m_vertices.push_back(SDL_Vertex {SDL_FPoint {x + size, y}, white, SDL_FPoint {u1, v0}});
+    m_vertices.push_back(SDL_Vertex {SDL_FPoint {x + size, y + size}, white, SDL_FPoint {u1, v1}});
+    m_vertices.push_back(SDL_Vertex {SDL_FPoint {x, y + size}, white, SDL_FPoint {u0, v1}});
+}
+
+bool MapLayer::ensureCacheTexture(SDL_Renderer* renderer, const SDL_Rect& viewport) {
+    // the ring holds unscaled world pixels, with one spare row and column so a view that
+    // straddles tile edges still fits without aliasing; zooming out grows it
+    const float tile_size = static_cast<float>(amb::game::MAP_TILE_SIZE);
+    const i32 cols = static_cast<i32>(std::ceil(viewWorldWidth(viewport) / tile_size)) + 1;
+    const i32 rows = static_cast<i32>(std::ceil(viewWorldHeight(viewport) / tile_size)) + 1;
+
+    if (m_cache_texture != nullptr && cols == m_cache_cols && rows == m_cache_rows) {
+        return true;
+    }
+
+    m_cache_valid = false;
+    m_cache_texture.reset(SDL_CreateTexture(
+        renderer,
+        SDL_PIXELFORMAT_ABGR8888,
+        SDL_TEXTUREACCESS_TARGET,
+        cols * static_cast<i32>(amb::game::MAP_TILE_SIZE),
+        rows * static_cast<i32>(amb::game::MAP_TILE_SIZE)));
+
+    if (m_cache_texture == nullptr) {
+        SDL_Log("MapLayer::render failed to create render cache, drawing tiles directly: %s", SDL_GetError());
+        m_cache_enabled = false;
+        return false;
+    }
+
+    // tiles are blended onto transparent slots, which leaves premultiplied colour in the ring
+    if (!SDL_SetTextureBlendMode(m_cache_texture.get(), SDL_BLENDMODE_BLEND_PREMULTIPLIED) ||
+        !SDL_SetTextureScaleMode(m_cache_texture.get(), SDL_SCALEMODE_NEAREST)) {
+        SDL_Log("MapLayer::render failed to configure render cache: %s", SDL_GetError());
+    }
+
+    m_cache_cols = cols;
+    m_cache_rows = rows;
+    ensureQuadIndices(static_cast<std::size_t>(cols) * static_cast<std::size_t>(rows));
+    return true;
+}
+
+void MapLayer::queueCacheTiles(const TileRange& tiles, const float texture_w, const float texture_h) {
+    for (i32 tile_y = tiles.min_ty; tile_y <= tiles.max_ty; ++tile_y) {
+        for (i32 tile_x = tiles.min_tx; tile_x <= tiles.max_tx; ++tile_x) {
+            queueCacheTile(tile_x, tile_y, texture_w, texture_h, true);
+        }
+    }
+}
+
+void MapLayer::queueCacheTile(
+    const i32 tile_x,
+    const i32 tile_y,
+    const float texture_w,
+    const float texture_h,
+    const bool track_animated)
+{
+    const float tile_size = static_cast<float>(amb::game::MAP_TILE_SIZE);
+    const float slot_x = static_cast<float>(wrapTile(tile_x, m_cache_cols)) * tile_size;
+    const float slot_y = static_cast<float>(wrapTile(tile_y, m_cache_rows)) * tile_size;
+    m_cache_clears.push_back(SDL_FRect {slot_x, slot_y, tile_size, tile_size});
+
+    if (tile_x < 0 || tile_y < 0) {
+        return;
+    }
+
+    const std::vector<SDL_FRect>& rects = atlas().rects;
+    const Cell* cell = m_map_runtime.cellAtTile(static_cast<std::size_t>(tile_x), static_cast<std::size_t>(tile_y));
+    if (cell == nullptr || static_cast<std::size_t>(*cell) >= rects.size() ||
+        tileHidden(static_cast<std::size_t>(tile_x), static_cast<std::size_t>(tile_y))) {
+        return;
+    }
+
+    if (track_animated && m_animator.animated(*cell)) {
+        m_cache_animated.push_back(TilePosition {tile_x, tile_y});
+    }
+
+    appendTileQuad(rects[m_animator.remap(*cell)], slot_x, slot_y, tile_size, texture_w, texture_h);
+}
+
+bool MapLayer::flushCacheTiles(SDL_Renderer* renderer) {
+    SDL_Texture* previous_target = SDL_GetRenderTarget(renderer);
+    SDL_BlendMode previous_blend = SDL_BLENDMODE_NONE;
+    u8 previous_r = 0;
+    u8 previous_g = 0;
+    u8 previous_b = 0;
+    u8 previous_a = 0;
+    SDL_GetRenderDrawBlendMode(renderer, &previous_blend);
+    SDL_GetRenderDrawColor(renderer, &previous_r, &previous_g, &previous_b, &previous_a);
+
+    const std::size_t quad_count = m_vertices.size() / VERTICES_PER_QUAD;
+    bool ok = SDL_SetRenderTarget(renderer, m_cache_texture.get())
+        && SDL_SetRenderViewport(renderer, nullptr)
+        && SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE)
+        && SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0)
+        && SDL_RenderFillRects(renderer, m_cache_clears.data(), static_cast<int>(m_cache_clears.size()));
+    countDrawCall(0);
+
+    if (ok && quad_count > 0) {
+        ok = SDL_RenderGeometry(
+            renderer,
+            image().texture.get(),
+            m_vertices.data(),
+            static_cast<int>(quad_count * VERTICES_PER_QUAD),
+            m_indices.data(),
+            static_cast<int>(quad_count * INDICES_PER_QUAD));
+        countDrawCall(quad_count);
+    }
+
+    if (!ok) {
+        SDL_Log("MapLayer::render failed to update render cache: %s", SDL_GetError());
+    }
+
+    // the viewport is per target, so switching back restores the layer viewport as well
+    SDL_SetRenderTarget(renderer, previous_target);
+    SDL_SetRenderDrawBlendMode(renderer, previous_blend);
+    SDL_SetRenderDrawColor(renderer, previous_r, previous_g, previous_b, previous_a);
+    return ok;
+}
+
+void MapLayer::blitCache(SDL_Renderer* renderer, const SDL_Rect& viewport) {
+    const float tile_size = static_cast<float>(amb::game::MAP_TILE_SIZE);
+    const float ring_w = static_cast<float>(m_cache_cols) * tile_size;
+    const float ring_h = static_cast<float>(m_cache_rows) * tile_size;
+    const amb::runtime::CameraView& camera_view = view();
+    const float view_w = viewWorldWidth(viewport);
+    const float view_h = viewWorldHeight(viewport);
+
+    // the view rectangle wraps at most once per axis, so it is copied in up to four pieces
+    const float origin_x = wrapPixel(camera_view.world_x, ring_w);
+    const float origin_y = wrapPixel(camera_view.world_y, ring_h);
+    const float first_w = std::min(view_w, ring_w - origin_x);
+    const float first_h = std::min(view_h, ring_h - origin_y);
+
+    const float source_x[2] {origin_x, 0.0f};
+    const float source_y[2] {origin_y, 0.0f};
+    const float width[2] {first_w, view_w - first_w};
+    const float height[2] {first_h, view_h - first_h};
+    const float target_x[2] {0.0f, first_w};
+    const float target_y[2] {0.0f, first_h};
+
+    for (int row = 0; row < 2; row++) {
+        for (int col = 0; col < 2; col++) {
+            if (width[col] <= 0.0f || height[row] <= 0.0f) {
+                continue;
+            }
+
+            const SDL_FRect source {source_x[col], source_y[row], width[col], height[row]};
+            const SDL_FRect target {
+                target_x[col] * camera_view.zoom,
+                target_y[row] * camera_view.zoom,
+                width[col] * camera_view.zoom,
+                height[row] * camera_view.zoom,
+            };
+            countDrawCall(0);
+            if (!SDL_RenderTexture(renderer, m_cache_texture.get(), &source, &target)) {
+                SDL_Log("MapLayer::render failed to draw render cache: %s", SDL_GetError());
+                return;
+            }
+        }
+    }
+}
+
+void composeLayerOcclusion(const std::vector<VisualLayerPtr>& layers) {
+    // a layer's viewport follows from its map size, so only maps of the same size draw every tile at the same
+    // screen position; each size keeps its own coverage grid
+    struct CoverageGrid {
+        std::size_t width = 0;
+        std::size_t height = 0;
+        std::vector<u64> covered;
+    };
+    std::vector<CoverageGrid> grids;
+
+    // walks from the top layer down, accumulating every cell an opaque tile already covers
+    for (auto it = layers.rbegin(); it != layers.rend(); ++it) {
+        auto* map_layer = dynamic_cast<MapLayer*>(it->get());
+        if (map_layer == nullptr || map_layer->parallax() != 1.0f) {
+            continue;
+        }
+
+        const MapRuntime& map = static_cast<const MapLayer&>(*map_layer).map();
+        auto grid = std::find_if(grids.begin(), grids.end(), [&map](const CoverageGrid& candidate) {
+            return candidate.width == map.width() && candidate.height == map.height();
+        });
+        if (grid == grids.end()) {
+            grids.push_back(CoverageGrid {map.width(), map.height(), std::vector<u64>((map.width() * map.height() + 63) / 64, 0)});
+            grid = grids.end() - 1;
+        }
+
+        std::vector<u64>& covered = grid->covered;
+        std::vector<u64> hidden(covered.size(), 0);
+        bool any_hidden = false;
+
+        for (std::size_t tile_y = 0; tile_y < map.height(); tile_y++) {
+            for (std::size_t tile_x = 0; tile_x < map.width(); tile_x++) {
+                const std::size_t index = tile_y * map.width() + tile_x;
+                const u64 bit = u64 {1} << (index % 64);
+
+                if ((covered[index / 64] & bit) != 0) {
+                    hidden[index / 64] |= bit;
+                    any_hidden = true;
+                } else if (map_layer->tileOpaque(tile_x, tile_y)) {
+                    covered[index / 64] |= bit;
+                }
+            }
+        }
+
+        map_layer->setHiddenTiles(any_hidden ? std::move(hidden) : std::vector<u64> {});
+    }
+}
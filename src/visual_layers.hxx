@@ -1,17 +1,30 @@
 #ifndef VISUAL_LAYERS_HXX_INCLUDED
 #define VISUAL_LAYERS_HXX_INCLUDED
 
+#include "runtime_animation.hxx"
 #include "runtime_image.hxx"
 #include "runtime_atlas.hxx"
+#include "runtime_collision.hxx"
 #include "runtime_map.hxx"
+#include "runtime_camera.hxx"
 #include "config.hxx"
 
+#include <cstddef>
 #include <memory>
 #include <utility>
+#include <vector>
+
+namespace amb::runtime {
+    // what the latest render() submitted to the renderer
+    struct LayerRenderStats {
+        u32 draw_calls = 0;
+        u32 tiles_drawn = 0;  // tiles rasterized this frame, into the target or into a cache
+    };
+}
 
 class VisualLayer {
 public:
-    VisualLayer(ImageRuntime image_runtime, AtlasRuntime atlas_runtime)
+    VisualLayer(ImageRuntimePtr image_runtime, AtlasRuntimePtr atlas_runtime)
     : m_image_runtime(std::move(image_runtime)),
       m_atlas_runtime(std::move(atlas_runtime)) {}
 
@@ -19,94 +32,207 @@ public:
 
     virtual void render(SDL_Renderer* renderer) = 0;
 
-    ImageRuntime& image() noexcept { return m_image_runtime; }
-    const ImageRuntime& image() const noexcept { return m_image_runtime; }
+    // drops any off-screen copy of the layer, e.g. after the renderer lost its render targets
+    virtual void invalidateRenderCache() noexcept {}
+
+    // advances time-driven content by one update step
+    virtual void animate(u32 elapsed_ms) { (void)elapsed_ms; }
+
+    // image and atlas may be shared with other layers, so layers only get read access
+    const ImageRuntime& image() const noexcept { return *m_image_runtime; }
+    const AtlasRuntime& atlas() const noexcept { return *m_atlas_runtime; }
+
+    // set by the render pass from the camera before render(); world_x/world_y is the viewport's top-left
+    void setView(const amb::runtime::CameraView& view) noexcept { m_view = view; }
+    const amb::runtime::CameraView& view() const noexcept { return m_view; }
+
+    // share of the camera movement the layer follows (1 = world layer, below 1 = distant background)
+    void setParallax(float parallax) noexcept {
+        m_parallax = parallax;
+        markContentDirty();
+    }
+    float parallax() const noexcept { return m_parallax; }
+
+    // layers are drawn in ascending z; equal z keeps load order
+    void setZ(i32 z) noexcept {
+        m_z = z;
+        markContentDirty();
+    }
+    i32 z() const noexcept { return m_z; }
+
+    const amb::runtime::LayerRenderStats& renderStats() const noexcept { return m_render_stats; }
 
-    AtlasRuntime& atlas() noexcept { return m_atlas_runtime; }
-    const AtlasRuntime& atlas() const noexcept { return m_atlas_runtime; }
+    // set when the layer changed in a way the last presented frame does not show yet; camera moves are
+    // tracked by the caller. new layers start dirty, the render pass clears the flag
+    bool contentDirty() const noexcept { return m_content_dirty; }
+    void markContentDirty() noexcept { m_content_dirty = true; }
+    void clearContentDirty() noexcept { m_content_dirty = false; }
+
+protected:
+    void resetRenderStats() noexcept { m_render_stats = {}; }
+    void countDrawCall(std::size_t tiles) noexcept {
+        m_render_stats.draw_calls++;
+        m_render_stats.tiles_drawn += static_cast<u32>(tiles);
+    }
 
 private:
-    ImageRuntime m_image_runtime;
-    AtlasRuntime m_atlas_runtime;
+    ImageRuntimePtr m_image_runtime;
+    AtlasRuntimePtr m_atlas_runtime;
+
+    amb::runtime::CameraView m_view {};
+    float m_parallax = 1.0f;
+    i32 m_z = 0;
+    amb::runtime::LayerRenderStats m_render_stats {};
+    bool m_content_dirty = true;
 };
 
 using VisualLayerPtr = std::unique_ptr<VisualLayer>;
 
 class MapLayer final : public VisualLayer {
 public:
-    MapLayer(ImageRuntime image_runtime,
-             AtlasRuntime atlas_runtime,
+    MapLayer(ImageRuntimePtr image_runtime,
+             AtlasRuntimePtr atlas_runtime,
              MapRuntime map_runtime,
              amb::runtime::SpawnPoint spawn_point)
     : VisualLayer(std::move(image_runtime), std::move(atlas_runtime)),
       m_map_runtime(std::move(map_runtime)),
-      m_spawn_point(std::move(spawn_point)) {}
+      m_spawn_point(std::move(spawn_point)) {
+        m_animator.reset(atlas());
+    }
+
+    // draws the tiles inside the current view, either straight from the atlas in one
+    // SDL_RenderGeometry batch or, in cache mode, from a wrap-around render target
+    void render(SDL_Renderer* renderer) override;
+    void invalidateRenderCache() noexcept override {
+        m_cache_valid = false;
+        markContentDirty();
+    }
 
-    void render(SDL_Renderer* renderer) override {
-        if (renderer == nullptr || image().texture == nullptr || amb::game::MAP_TILE_SIZE == 0) {
-            return;
+    // animated cells are remapped through the animator; only their quads or ring slots are refreshed
+    void animate(u32 elapsed_ms) override {
+        if (m_animator.advance(elapsed_ms)) {
+            markContentDirty();
         }
+    }
+    const TileAnimator& animator() const noexcept { return m_animator; }
+
+    // cache mode keeps the visible tiles in a target texture and only draws newly exposed rows and columns
+    void setRenderCacheEnabled(bool enabled) noexcept;
+    bool renderCacheEnabled() const noexcept { return m_cache_enabled; }
+
+    // mutable access may edit cells, so cached geometry and the render cache are rebuilt on the next render
+    MapRuntime& map() noexcept {
+        m_geometry_dirty = true;
+        m_cache_valid = false;
+        markContentDirty();
+        return m_map_runtime;
+    }
+    const MapRuntime& map() const noexcept { return m_map_runtime; }
 
-        SDL_Rect viewport {0, 0, 0, 0};
-        if (!SDL_GetRenderViewport(renderer, &viewport)) {
-            SDL_Log("MapLayer::render failed to query viewport: %s", SDL_GetError());
-            return;
+    // one bit per cell (row-major, LSB first) for tiles covered by opaque tiles of higher layers;
+    // hidden tiles are skipped when drawing. an empty set hides nothing
+    void setHiddenTiles(std::vector<u64> hidden_tiles) noexcept;
+    bool tileHidden(std::size_t tile_x, std::size_t tile_y) const noexcept {
+        if (m_hidden_tiles.empty()) {
+            return false;
         }
 
+        const std::size_t index = tile_y * m_map_runtime.width() + tile_x;
+        return ((m_hidden_tiles[index / 64] >> (index % 64)) & 1u) != 0;
+    }
+
+    // true when the tile draws and fully covers its cell
+    bool tileOpaque(std::size_t tile_x, std::size_t tile_y) const noexcept {
+        const Cell* cell = m_map_runtime.cellAtTile(tile_x, tile_y);
+        return cell != nullptr && static_cast<std::size_t>(*cell) < atlas().opaque.size() && atlas().opaque[*cell] != 0;
+    }
+
+    amb::runtime::SpawnPoint& spawnPoint() noexcept { return m_spawn_point; }
+    const amb::runtime::SpawnPoint& spawnPoint() const noexcept { return m_spawn_point; }
+
+    // solid cells from the atlas's ATLS_RECORD_FLAG_SOLID, built by the loader off the main thread;
+    // edits made through map() show up after rebuildCollision()
+    const CollisionMap& collision() const noexcept { return m_collision; }
+    void setCollision(CollisionMap collision) noexcept { m_collision = std::move(collision); }
+    void rebuildCollision() { m_collision = CollisionMap::build(m_map_runtime, atlas().solid); }
+
+private:
+    struct TileRange {
         i32 min_tx = 0;
         i32 max_tx = -1;
         i32 min_ty = 0;
         i32 max_ty = -1;
-        map().clampVisibleWorldToTileRange(
-            0.0f,
-            0.0f,
-            static_cast<float>(viewport.w),
-            static_cast<float>(viewport.h),
-            min_tx,
-            max_tx,
-            min_ty,
-            max_ty);
-
-        if (max_tx < min_tx || max_ty < min_ty) {
-            return;
-        }
 
-        for (i32 tile_y = min_ty; tile_y <= max_ty; ++tile_y) {
-            for (i32 tile_x = min_tx; tile_x <= max_tx; ++tile_x) {
-                const Cell* cell = map().cellAtTile(static_cast<std::size_t>(tile_x), static_cast<std::size_t>(tile_y));
-                if (cell == nullptr) {
-                    continue;
-                }
-
-                const std::size_t atlas_index = static_cast<std::size_t>(*cell);
-                if (atlas_index >= atlas().rects.size()) {
-                    continue;
-                }
-
-                const SDL_FRect& source_rect = atlas().rects[atlas_index];
-                const SDL_FRect destination_rect {
-                    static_cast<float>(tile_x * amb::game::MAP_TILE_SIZE),
-                    static_cast<float>(tile_y * amb::game::MAP_TILE_SIZE),
-                    static_cast<float>(amb::game::MAP_TILE_SIZE),
-                    static_cast<float>(amb::game::MAP_TILE_SIZE),
-                };
-
-                SDL_RenderTexture(renderer, image().texture.get(), &source_rect, &destination_rect);
-            }
+        bool operator==(const TileRange& other) const noexcept {
+            return min_tx == other.min_tx && max_tx == other.max_tx && min_ty == other.min_ty && max_ty == other.max_ty;
         }
-    }
+    };
 
-    MapRuntime& map() noexcept { return m_map_runtime; }
-    const MapRuntime& map() const noexcept { return m_map_runtime; }
+    void renderBatched(SDL_Renderer* renderer, const SDL_Rect& viewport);
+    void renderCached(SDL_Renderer* renderer, const SDL_Rect& viewport);
 
-    amb::runtime::SpawnPoint& spawnPoint() noexcept { return m_spawn_point; }
-    const amb::runtime::SpawnPoint& spawnPoint() const noexcept { return m_spawn_point; }
+    // viewport size in world pixels at the current zoom
+    float viewWorldWidth(const SDL_Rect& viewport) const noexcept { return static_cast<float>(viewport.w) / view().zoom; }
+    float viewWorldHeight(const SDL_Rect& viewport) const noexcept { return static_cast<float>(viewport.h) / view().zoom; }
+
+    void rebuildGeometry(const TileRange& range);
+    void refreshAnimatedQuads();
+    bool queryAtlasSize(float& texture_w, float& texture_h) const;
+    void ensureQuadIndices(std::size_t quad_count);
+    void appendTileQuad(const SDL_FRect& source, float x, float y, float size, float texture_w, float texture_h);
+
+    bool ensureCacheTexture(SDL_Renderer* renderer, const SDL_Rect& viewport);
+    void queueCacheTiles(const TileRange& tiles, float texture_w, float texture_h);
+    void queueCacheTile(i32 tile_x, i32 tile_y, float texture_w, float texture_h, bool track_animated);
+    bool flushCacheTiles(SDL_Renderer* renderer);
+    void blitCache(SDL_Renderer* renderer, const SDL_Rect& viewport);
 
-private:
     MapRuntime m_map_runtime;
     amb::runtime::SpawnPoint m_spawn_point;
+    std::vector<u64> m_hidden_tiles;
+    CollisionMap m_collision;
+    TileAnimator m_animator;
+
+    struct AnimatedQuad {
+        std::size_t quad = 0;
+        Cell cell = 0;
+    };
+
+    struct TilePosition {
+        i32 x = 0;
+        i32 y = 0;
+    };
+
+    // one quad per drawn tile; buffers only ever grow, so steady-state frames do not allocate.
+    // cache mode reuses them for the tiles it redraws, which leaves the batched geometry dirty
+    std::vector<SDL_Vertex> m_vertices;
+    std::vector<int> m_indices;
+    std::size_t m_quad_count = 0;
+    TileRange m_geometry_range {};
+    amb::runtime::CameraView m_geometry_view {};
+    bool m_geometry_dirty = true;
+    std::vector<AnimatedQuad> m_animated_quads;  // quads whose uvs follow the animator
+    u64 m_geometry_animation = 0;                // animator version the uvs were written for
+    float m_texture_w = 0.0f;
+    float m_texture_h = 0.0f;
+
+    // ring of m_cache_cols x m_cache_rows tiles; tile (x, y) always lives in slot (x mod cols, y mod rows)
+    bool m_cache_enabled = amb::config::MAP_LAYER_RENDER_CACHE;
+    TexturePtr m_cache_texture;
+    i32 m_cache_cols = 0;
+    i32 m_cache_rows = 0;
+    TileRange m_cache_range {};
+    bool m_cache_valid = false;
+    std::vector<SDL_FRect> m_cache_clears;
+    std::vector<TilePosition> m_cache_animated;  // animated tiles inside m_cache_range
+    u64 m_cache_animation = 0;
 };
 
+// recomputes MapLayer::setHiddenTiles for `layers`, which must already be in draw order. only layers that
+// follow the camera exactly (parallax 1) and have the same map size share a tile grid; layers of other sizes
+// sit in differently sized viewports, so they neither hide nor get hidden by them
+void composeLayerOcclusion(const std::vector<VisualLayerPtr>& layers);
+
 class SpriteLayer : public VisualLayer {
 public:
     virtual ~SpriteLayer() = default;